@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+//  global operator new is replaced only in builds with VK_ALLOC_COUNTING (cmake -DALLOC_COUNTING=ON); phases of the
+//  frame are the CPU zones, which count the allocations made on their thread in such builds. Elsewhere nothing is left
+#if defined(VK_ALLOC_COUNTING)
+#define VK_ALLOC_PHASE_CONCAT_(a, b) a##b
+#define VK_ALLOC_PHASE_CONCAT(a, b)  VK_ALLOC_PHASE_CONCAT_(a, b)
+#define VK_ALLOC_PHASE(name)         VKAllocCounter::Phase VK_ALLOC_PHASE_CONCAT(allocphase_, __LINE__) {name}
+#else
+#define VK_ALLOC_PHASE(name)
+#endif
+
+namespace VKAllocCounter
+{
+
+#if defined(VK_ALLOC_COUNTING)
+constexpr bool ALLOC_COUNTING = true;
+#else
+constexpr bool ALLOC_COUNTING = false;
+#endif
+
+constexpr uint32_t MAX_PHASES = 64;   //  distinct phase names, later ones are not counted
+
+//  allocations through operator new since startup, of all threads and of the calling one; always zero without counting
+uint64_t allocations();
+uint64_t threadAllocations();
+
+//  adds the allocations its thread makes from construction to destruction to the phase of that name; phases nest,
+//  so the counts are inclusive
+class Phase final
+{
+    const char*       name_;
+    uint64_t         begin_;
+
+public:
+
+    explicit Phase (const char* name) : name_{name}, begin_{threadAllocations()} {}
+    ~Phase();
+
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+};
+
+//  allocations and runs of every phase so far; writes nothing without counting
+void report(std::ostream& stream);
+
+}   //  end of VKAllocCounter namespace
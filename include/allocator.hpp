@@ -0,0 +1,109 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include <map>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <ostream>
+#include <functional>
+
+namespace VKAllocator
+{
+
+constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+struct Block;
+
+//  a range inside one of the allocator's blocks; resources are bound to memory at offset
+struct Allocation
+{
+    VkDeviceMemory  memory = VK_NULL_HANDLE;
+    VkDeviceSize    offset =              0;
+    VkDeviceSize      size =              0;
+    VkDeviceSize alignment =              1;     //  alignment the range was placed with, defragmentation keeps it
+    void*           mapped =        nullptr;     //  host pointer to offset, only for host visible memory
+    uint32_t    memorytype =              0;
+    void*         userdata =        nullptr;     //  owner passed to the defragmentation hook, nullptr means unmovable
+
+    Block*           block =        nullptr;
+};
+
+struct Block
+{
+    VkDeviceMemory                              memory = VK_NULL_HANDLE;
+    VkDeviceSize                                  size =              0;
+    void*                                       mapped =        nullptr;
+    uint32_t                                memorytype =              0;
+    bool                                        linear =           true;   //  buffers and linear images never share a block with optimal images
+    bool                                     dedicated =          false;
+
+    VkDeviceSize                                  used =              0;
+    std::map<VkDeviceSize, VkDeviceSize>    freeranges;                    //  offset -> size, neighbours are always coalesced
+    std::map<VkDeviceSize, Allocation>     allocations;                    //  offset -> allocation
+};
+
+struct Statistics
+{
+    std::size_t        blockcount = 0;
+    std::size_t    dedicatedcount = 0;
+    std::size_t   allocationcount = 0;
+    std::size_t    freerangecount = 0;
+    VkDeviceSize    reservedbytes = 0;     //  sum of all vkAllocateMemory sizes
+    VkDeviceSize        usedbytes = 0;
+    VkDeviceSize largestfreerange = 0;
+};
+
+std::ostream& operator<< (std::ostream& os, const Statistics& statistics);
+
+class Allocator final
+{
+public:
+    //  hook for moving one allocation during defragmentation: owner has to bind a new resource to "to",
+    //  copy the content and release the old resource; returning false keeps the allocation where it was.
+    //  It is called under the allocator lock, so it must not allocate or free through the allocator.
+    using MoveCallback = std::function<bool (const Allocation& from, const Allocation& to)>;
+
+private:
+    VkDevice                                                  device_ = VK_NULL_HANDLE;
+    VkPhysicalDeviceMemoryProperties                      memoryprops_;
+    VkDeviceSize                                            blocksize_;
+    VkDeviceSize                                   noncoherentatomsize_;
+
+    std::vector<std::unique_ptr<Block>>                        blocks_;
+    mutable std::mutex                                          mutex_;
+
+public:
+
+    Allocator (VkPhysicalDevice physdevice, VkDevice device, const VkPhysicalDeviceProperties& properties,
+               VkDeviceSize blocksize = DEFAULT_BLOCK_SIZE);
+    ~Allocator();
+
+    Allocator(const Allocator&) = delete;
+    Allocator& operator=(const Allocator&) = delete;
+
+    //  linear is true for buffers and linear-tiled images, false for optimal-tiled images
+    Allocation allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, void* userdata = nullptr);
+    void           free(Allocation& allocation);
+
+    //  moves movable allocations out of the least occupied blocks and releases the blocks which become empty;
+    //  returns the amount of moved bytes
+    VkDeviceSize defragment(const MoveCallback& move, VkDeviceSize maxbytes = VK_WHOLE_SIZE);
+
+    Statistics getStatistics() const;
+
+    uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+private:
+    Block* createBlock(VkDeviceSize size, uint32_t memorytype, bool linear, bool dedicated);
+    void  destroyBlock(Block* block);
+
+    bool allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation);
+    void     releaseRange (Block& block, VkDeviceSize offset, VkDeviceSize size);
+
+    VkDeviceSize preferredBlockSize(uint32_t memorytype) const;
+};
+
+}   //  end of VKAllocator namespace
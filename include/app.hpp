@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <chrono>
+#include <string>
 
 #include "window.hpp"
 #include "instance.hpp"
@@ -12,6 +13,10 @@
 #include "keyboard_controller.hpp"
 #include "buffmanager.hpp"
 #include "descriptors.hpp"
+#include "asset_registry.hpp"
+#include "thread_pool.hpp"
+#include "texture_loader.hpp"
+#include "transform_system.hpp"
 
 namespace VKEngine
 {
@@ -22,29 +27,50 @@ struct GlobalUbo
     glm::vec3 lightDirection = glm::normalize(glm::vec3{-2.0, -3.0, -1.0});
 };
 
+//  frames the caches, arenas and query readbacks need to reach their size; allocations after them are a regression
+constexpr uint32_t ALLOC_WARMUP_FRAMES = 8;
+
+struct Settings
+{
+    bool                headless = false;  //  no window and no surface, frames are rendered to offscreen images
+    uint32_t            frames   =   300;  //  headless run length
+    std::string      capturepath;          //  last headless frame is written there as PPM unless empty
+    std::string      profilepath;          //  GPU scope averages are written there at exit and on P, CSV or JSON by extension
+    std::string        tracepath;          //  CPU zones are written there at exit as Chrome trace, needs a CPU_PROFILING build
+    bool              allocfree = false;  //  headless run fails if a frame after the warmup allocated, needs an ALLOC_COUNTING build
+
+    VKSwapchain::PresentPolicy present{};  //  present mode, swapchain images and frame rate cap of the window
+};
+
 class App final
 {
+    Settings                     settings_;
     VKWindow::Window               window_;
     VKInstance::Instance         instance_;
     VKDevice::Device               device_;
     VKRenderer::Renderer         renderer_;
+    VKThreadPool::ThreadPool    threadpool_;
+    VKTextureLoader::TextureLoader textures_;
+    VKAssetRegistry::AssetRegistry  assets_;
 
     //  oreder matters
     std::unique_ptr<VKDescriptors::DescriptorPool> globalPool {};
+    VKTransformSystem::TransformSystem               transforms_;
     std::vector<VKObject::Object>                       objects_;
 
 public:
-    App() : 
+    App(const Settings& settings = Settings{}) : settings_{settings},
         window_{VKWindow::DEFAULT_WIDTH, 
                 VKWindow::DEFAULT_HEIGHT, 
-                VKWindow::DEFAULT_WINDOW_NAME},
-        instance_{window_}, device_{instance_}, renderer_ {window_, device_}
+                VKWindow::DEFAULT_WINDOW_NAME,
+                settings.headless},
+        instance_{window_}, device_{instance_}, renderer_ {window_, device_, settings.present},
+        textures_{device_, threadpool_}, assets_{device_, &textures_}
     {
         loadObjects();
 
-        globalPool = VKDescriptors::DescriptorPool::Builder(device_).setMaxSets (VKSwapchain::MAX_FRAMES_IN_FLIGHT * (objects_.size() + 1))  //  max count of descriptor SETS which can be allocated in the future 
-                                                                    .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VKSwapchain::MAX_FRAMES_IN_FLIGHT)  //  add number of descriptors of certain type in pool
-                                                                    .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VKSwapchain::MAX_FRAMES_IN_FLIGHT * objects_.size()).build();
+        globalPool = VKDescriptors::DescriptorPool::Builder(device_).setMaxSets (1)  //  max count of descriptor SETS which can be allocated in the future 
+                                                                    .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1).build();  //  add number of descriptors of certain type in pool
     }
     ~App()= default;
 
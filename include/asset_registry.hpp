@@ -0,0 +1,112 @@
+#pragma once
+
+#include "device.hpp"
+#include "model.hpp"
+#include "thread_pool.hpp"
+#include "texture_loader.hpp"
+
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+namespace VKAssetRegistry
+{
+
+constexpr VkDeviceSize DEFAULT_MEMORY_BUDGET = 512ull * 1024 * 1024;  //  bytes of vertex, index and texture memory
+
+class AssetRegistry final
+{
+    //  identity of a model: where it was loaded from and what the files contained at that moment
+    struct Key
+    {
+        std::string  filepath_to_model;
+        std::string filepath_to_texture;
+        uint64_t              contenthash;
+
+        bool operator== (const Key& rhs) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator() (const Key& key) const;
+    };
+
+    struct Entry
+    {
+        std::shared_ptr<VKModel::Model> model_;
+        VkDeviceSize                     size_;
+        std::list<Key>::iterator       lruit_;  //  position in the usage list
+    };
+
+    //  content hash is remembered per file and recomputed only if the file was touched
+    struct FileStamp
+    {
+        uint64_t   filesize;
+        int64_t   writetime;
+        uint64_t  contenthash;
+    };
+
+    VKDevice::Device&                                   device_;
+    VKTextureLoader::TextureLoader*                   textures_;   //  streams textures of loadModels if set
+
+    std::unordered_map<Key, Entry, KeyHash>            entries_;
+    std::unordered_map<const VKModel::Model*, Entry*> entryofmodel_;    //  for texture publications, entries never move
+    std::list<Key>                                         lru_;    //  front is the most recently requested
+    std::unordered_map<std::string, FileStamp>      filestamps_;
+
+    VkDeviceSize                                        budget_;
+    VkDeviceSize                                  residentsize_ = 0;
+
+    std::size_t                                           hits_ = 0;
+    std::size_t                                         misses_ = 0;
+
+public:
+
+    struct Request
+    {
+        std::string   filepath_to_model;
+        std::string filepath_to_texture;
+    };
+
+    AssetRegistry (VKDevice::Device& device, VKTextureLoader::TextureLoader* textures = nullptr, VkDeviceSize budget = DEFAULT_MEMORY_BUDGET);
+    ~AssetRegistry();
+
+    AssetRegistry(const AssetRegistry&) = delete;
+    AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+    //  returns resident model if the same files were already loaded, otherwise loads them through Model::createModelfromFile
+    std::shared_ptr<VKModel::Model> loadModel (const std::string& filepath_to_model, const std::string& filepath_to_texture = std::string{});
+
+    //  same for a whole scene: meshes which are not resident yet are imported concurrently on the pool,
+    //  GPU resources are created afterwards on the calling thread; the result is parallel to requests.
+    //  With a texture loader the models come back untextured and get their textures once those are decoded and uploaded;
+    //  the texture memory is added to their size when it is published, and the budget is enforced again at that moment
+    std::vector<std::shared_ptr<VKModel::Model>> loadModels (const std::vector<Request>& requests, VKThreadPool::ThreadPool& pool);
+
+    //  drops least recently used models which are not referenced outside of the registry until the budget is met
+    void trim();
+    void clear();
+
+    void         setMemoryBudget(VkDeviceSize budget) { budget_ = budget; trim(); }
+    VkDeviceSize getMemoryBudget() const              { return budget_;       }
+    VkDeviceSize getResidentSize() const              { return residentsize_; }
+    std::size_t  getModelCount  () const              { return entries_.size(); }
+    std::size_t  getHitCount    () const              { return hits_;   }
+    std::size_t  getMissCount   () const              { return misses_; }
+
+private:
+    uint64_t hashFile(const std::string& filepath);
+
+    Key makeKey(const std::string& filepath_to_model, const std::string& filepath_to_texture);
+
+    std::shared_ptr<VKModel::Model>   find(const Key& key);
+    void                            insert(Key key, const std::shared_ptr<VKModel::Model>& model);
+
+    //  recounts the size of a model after the texture loader published its texture
+    void onTexturePublished(const VKModel::Model& model);
+};
+
+}   //  end of VKAssetRegistry namespace
@@ -0,0 +1,65 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "device.hpp"
+#include "descriptors.hpp"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace VKBindless
+{
+
+//  upper bound of the array; devices with lower update-after-bind limits get an array as large as their limits allow
+constexpr uint32_t MAX_BINDLESS_TEXTURES = 4096;
+constexpr uint32_t      FALLBACK_TEXTURE =    0;   //  1x1 white texel, used by untextured models and freed slots
+
+//  every texture of the scene lives in one descriptor set as an element of a sampler array; instances carry
+//  the index of their element, so a frame binds textures once instead of one set per object.
+//  Slots are written with update-after-bind, so textures can come and go while frames are in flight
+class TextureArray final
+{
+    VKDevice::Device&                                      device_;
+
+    std::unique_ptr<VKDescriptors::DescriptorSetLayout>     layout_;
+    std::unique_ptr<VKDescriptors::DescriptorPool>            pool_;
+    VkDescriptorSet                                           set_ = VK_NULL_HANDLE;
+
+    VkImage                                         fallbackimg_ = VK_NULL_HANDLE;
+    VKAllocator::Allocation                      fallbackimgmem_{};
+    VkImageView                                 fallbackimgview_ = VK_NULL_HANDLE;
+    VkSampler                                   fallbacksampler_ = VK_NULL_HANDLE;
+
+    uint32_t                                           capacity_;
+    uint32_t                                           nextslot_ = FALLBACK_TEXTURE + 1;
+    std::vector<uint32_t>                             freeslots_;
+
+public:
+
+    TextureArray (VKDevice::Device& device);
+    ~TextureArray();
+
+    TextureArray(const TextureArray&) = delete;
+    TextureArray& operator=(const TextureArray&) = delete;
+
+    //  writes the texture into a free slot and returns its index; the view has to stay alive until remove
+    uint32_t add   (VkImageView view, VkSampler sampler);
+    //  points the slot back at the fallback texture and lets add reuse it
+    void     remove(uint32_t index);
+
+    //  elements the array gets on the device, MAX_BINDLESS_TEXTURES clamped to its update-after-bind limits
+    static uint32_t deviceCapacity(VkPhysicalDevice device);
+
+    VkDescriptorSetLayout get_layout() const { return layout_->getDescriptorSetLayout(); }
+    VkDescriptorSet       get_set   () const { return set_; }
+    uint32_t         get_capacity   () const { return capacity_; }
+
+private:
+    void createFallbackTexture();
+    void write(uint32_t index, VkImageView view, VkSampler sampler);
+};
+
+}   //  end of VKBindless namespace
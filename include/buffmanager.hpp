@@ -10,7 +10,7 @@ class Buffmanager
     VKDevice::Device&                  device_;
     void*             mapped_ =        nullptr;
     VkBuffer          buffer_ = VK_NULL_HANDLE;
-    VkDeviceMemory    memory_ = VK_NULL_HANDLE;
+    VKAllocator::Allocation        allocation_;
 
     VkDeviceSize                   buffersize_;
     uint32_t                    instancecount_;
@@ -46,7 +46,7 @@ public:
     void*                        getMappedMemory() const              { return mapped_; }
     uint32_t                    getInstanceCount() const       { return instancecount_; }
     VkDeviceSize                 getInstanceSize() const        { return instancesize_; }
-    VkDeviceSize                getAlignmentSize() const        { return instancesize_; }
+    VkDeviceSize                getAlignmentSize() const       { return alignmentsize_; }
     VkBufferUsageFlags             getUsageFlags() const          { return usageflags_; }
     VkMemoryPropertyFlags getMemoryPropertyFlags() const { return memorypropertyflags_; }
     VkDeviceSize                   getBufferSize() const          { return buffersize_; }
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <cstdint>
+#include <ostream>
+
+#include "alloc_counter.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#endif
+
+//  zones exist only in builds with VK_CPU_PROFILING (cmake -DCPU_PROFILING=ON), elsewhere the macros leave nothing behind;
+//  with allocation counting every zone is an allocation phase as well
+#if defined(VK_CPU_PROFILING)
+#define VK_CPU_ZONE_CONCAT_(a, b) a##b
+#define VK_CPU_ZONE_CONCAT(a, b)  VK_CPU_ZONE_CONCAT_(a, b)
+#define VK_CPU_ZONE(name)         VKProfiler::CpuZone VK_CPU_ZONE_CONCAT(cpuzone_, __LINE__) {name}; VK_ALLOC_PHASE(name)
+#define VK_CPU_THREAD(name)       VKProfiler::nameThread(name)
+#else
+#define VK_CPU_ZONE(name)         VK_ALLOC_PHASE(name)
+#define VK_CPU_THREAD(name)
+#endif
+
+namespace VKProfiler
+{
+
+#if defined(VK_CPU_PROFILING)
+constexpr bool CPU_PROFILING = true;
+#else
+constexpr bool CPU_PROFILING = false;
+#endif
+
+constexpr uint32_t CPU_ZONE_CAPACITY = 1u << 16;   //  zones kept per thread, the oldest are overwritten
+
+//  time stamp counter where there is one, it is invariant on every x86 CPU the renderer targets; ticks are
+//  converted to microseconds against steady_clock when the trace is written
+inline uint64_t cpuTicks()
+{
+#if defined(__x86_64__) || defined(_M_X64)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+//  appends a finished zone to the ring buffer of the calling thread; names are string literals
+void recordZone(const char* name, uint64_t begin, uint64_t end);
+//  label of the calling thread in the trace, threads without one are listed by number
+void nameThread(const char* name);
+
+//  scope measured from construction to destruction
+class CpuZone final
+{
+    const char*  name_;
+    uint64_t    begin_;
+
+public:
+
+    explicit CpuZone (const char* name) : name_{name}, begin_{cpuTicks()} {}
+    ~CpuZone() { recordZone(name_, begin_, cpuTicks()); }
+
+    CpuZone(const CpuZone&) = delete;
+    CpuZone& operator=(const CpuZone&) = delete;
+};
+
+//  zones still held by the ring buffers of all threads as Chrome Trace Event JSON, for chrome://tracing or Perfetto;
+//  zones finished while writing may be torn, so the recording threads are supposed to be idle
+void writeChromeTrace(std::ostream& stream);
+void  dumpChromeTrace(const std::string& filepath);
+
+}   //  end of VKProfiler namespace
@@ -15,6 +15,7 @@ class DescriptorSetLayout
     VKDevice::Device&                                           device_;
     VkDescriptorSetLayout                           descriptorSetLayout;
     std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+    std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags;
  
     friend class DescriptorWriter;
 
@@ -24,16 +25,22 @@ public:
     {
         VKDevice::Device&                                             device_;
         std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings{};
+        std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags{};
+        VkDescriptorSetLayoutCreateFlags                         layoutFlags = 0;
 
     public:
 
         Builder(VKDevice::Device& device) : device_{device} {}
 
-        Builder &addBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags, uint32_t count = 1);
+        //  binding flags (partially bound, update after bind, ...) need descriptor indexing
+        Builder &addBinding(uint32_t binding, VkDescriptorType descriptorType, VkShaderStageFlags stageFlags, uint32_t count = 1,
+                            VkDescriptorBindingFlags flags = 0);
+        Builder &setLayoutFlags(VkDescriptorSetLayoutCreateFlags flags);
         std::unique_ptr<DescriptorSetLayout> build() const;
     };
 
-    DescriptorSetLayout(VKDevice::Device& device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+    DescriptorSetLayout(VKDevice::Device& device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+                        std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags = {}, VkDescriptorSetLayoutCreateFlags layoutFlags = 0);
     ~DescriptorSetLayout();
 
     DescriptorSetLayout(const DescriptorSetLayout &) = delete;
@@ -93,6 +100,7 @@ public:
 
     DescriptorWriter& writeBuffer(uint32_t binding, VkDescriptorBufferInfo *bufferInfo);
     DescriptorWriter&    writeImage(uint32_t binding, VkDescriptorImageInfo *imageInfo);
+    DescriptorWriter&  writeImageAt(uint32_t binding, uint32_t arrayElement, VkDescriptorImageInfo *imageInfo);  //  one element of an array binding
 
     bool build    (VkDescriptorSet &set);
     void overwrite(VkDescriptorSet &set);
@@ -4,25 +4,35 @@
 #include <GLFW/glfw3.h>
 
 #include "instance.hpp"
+#include "allocator.hpp"
 
 #include <set>
 #include <string>
+#include <memory>
 #include <vector>
 #include <optional>
 
+namespace VKUpload { class UploadContext; }
+namespace VKBindless { class TextureArray; }
+
 namespace VKDevice
 {
 
+const std::string PIPELINE_CACHE_FILE_NAME = "pipeline_cache.bin";
+
 struct QueueFamilyIndices
 {
     std::optional<uint32_t> graphics;
     std::optional<uint32_t>  present;
+    std::optional<uint32_t> transfer;   //  transfer-only family if the device has one, graphics otherwise
 
     auto is_graphics() { return graphics.has_value(); }
     auto  is_present() { return present.has_value();  }
+    auto is_transfer() { return transfer.has_value(); }
 
     auto get_graphics_value() { return graphics.value(); }
     auto  get_present_value() { return  present.value(); }
+    auto get_transfer_value() { return transfer.value(); }
 };
 
 class Device final
@@ -37,10 +47,24 @@ class Device final
 
     VkQueue                       graphics_queue_;
     VkQueue                        present_queue_;
+    VkQueue                       transfer_queue_;
     VkCommandPool                    commandpool_;
+    VkPipelineCache  pipelinecache_ = VK_NULL_HANDLE;   //  shared by every pipeline, kept on disk between runs
 
     VkPhysicalDeviceProperties        properties_;
-    const std::vector<const char *> deviceExtensions_ = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+
+    //  optional capabilities of GPU-driven drawing, enabled when the device has them
+    bool                     drawindirectcount_ = false;
+    bool             drawindirectfirstinstance_ = false;
+    bool                    pipelinestatistics_ = false;
+    bool                  texturecompressionbc_ = false;
+    bool                texturecompressionetc2_ = false;
+    std::vector<VkFormat>        textureformats_;   //  block-compressed formats textures can be sampled in, best first
+    PFN_vkCmdDrawIndirectCountKHR               cmddrawindirectcount_ = nullptr;
+    PFN_vkCmdDrawIndexedIndirectCountKHR cmddrawindexedindirectcount_ = nullptr;
+    std::unique_ptr<VKAllocator::Allocator> allocator_;
+    std::unique_ptr<VKUpload::UploadContext> uploader_;
+    std::unique_ptr<VKBindless::TextureArray> textures_;
 
 public:
 
@@ -60,6 +84,7 @@ public:
     VkDevice         get_logic  () { return logicdevice_;}
 
     VkCommandPool    get_cmdpool() { return commandpool_;}
+    VkPipelineCache  get_pipeline_cache() { return pipelinecache_; }
 
     bool is_graphics_complete() { return indices_.is_graphics(); }
     bool  is_present_complete() { return indices_.is_present();  }
@@ -69,18 +94,47 @@ public:
 
     VkQueue get_graphics_queue() { return graphics_queue_; }
     VkQueue  get_present_queue() {  return present_queue_; }
+    VkQueue get_transfer_queue() { return transfer_queue_; }
+
+    bool has_dedicated_transfer() { return indices_.get_transfer_value() != indices_.get_graphics_value(); }
 
     VkPhysicalDeviceProperties get_properties () const { return properties_;}
 
+    bool supports_indirect_count         () const { return drawindirectcount_;         }
+    bool supports_indirect_first_instance() const { return drawindirectfirstinstance_; }
+    bool supports_pipeline_statistics    () const { return pipelinestatistics_;        }
+
+    //  BC7, BC1 and ETC2 RGBA sRGB formats which can be sampled with linear filtering and copied to; order of preference
+    const std::vector<VkFormat>& get_texture_formats() const { return textureformats_; }
+    bool supports_texture_format(VkFormat format) const;
+
+    //  valid only if supports_indirect_count()
+    void cmdDrawIndirectCount       (VkCommandBuffer commandbuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countbuffer,
+                                     VkDeviceSize countoffset, uint32_t maxdrawcount, uint32_t stride)
+    {
+        cmddrawindirectcount_(commandbuffer, buffer, offset, countbuffer, countoffset, maxdrawcount, stride);
+    }
+    void cmdDrawIndexedIndirectCount(VkCommandBuffer commandbuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countbuffer,
+                                     VkDeviceSize countoffset, uint32_t maxdrawcount, uint32_t stride)
+    {
+        cmddrawindexedindirectcount_(commandbuffer, buffer, offset, countbuffer, countoffset, maxdrawcount, stride);
+    }
+    VKAllocator::Allocator&    get_allocator  ()       { return *allocator_;}
+    VKUpload::UploadContext&   get_uploader   ()       { return  *uploader_;}
+    VKBindless::TextureArray&  get_textures   ()       { return  *textures_;}
+
+    //  resources are unmovable by default; an owner opts in to defragmentation, it becomes Allocation::userdata and
+    //  the MoveCallback passed to Allocator::defragment has to know how to rebind the resource of that owner
     void createBuffer(VkDeviceSize size,VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                      VkBuffer &buffer, VkDeviceMemory &bufferMemory);
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+                      VkBuffer &buffer, VKAllocator::Allocation &allocation, void* owner = nullptr);
+    void destroyBuffer(VkBuffer buffer, VKAllocator::Allocation &allocation);
 
-    void createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, 
-                     VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height);
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout);
-    VkImageView createImageView(VkImage image, VkFormat format);
+    void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, 
+                     VkMemoryPropertyFlags properties, VkImage& image, VKAllocator::Allocation& allocation, void* owner = nullptr);
+    void createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties,
+                             VkImage &image, VKAllocator::Allocation &allocation, void* owner = nullptr);
+    void destroyImage(VkImage image, VKAllocator::Allocation &allocation);
+    VkImageView createImageView(VkImage image, VkFormat format, uint32_t mipLevels = 1);
 
     uint32_t findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
@@ -88,11 +142,13 @@ private:
     void pickPhysicalDevice (VKInstance::Instance& instance);
     void createLogicalDevice(VKInstance::Instance& instance);
     void createCommandPool  ();
+    void createPipelineCache();
+    void pickTextureFormats ();
+    void savePipelineCache  ();
 
     bool isDeviceSuitable(VkPhysicalDevice device, VKInstance::Instance &instance);
-
-    VkCommandBuffer beginSingleTimeCommands();
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer);
 };
 
+bool checkDeviceExtensionSupport(VkPhysicalDevice device, const std::vector<const char *> deviceExtensions);
+
 }   //  end of VKDevice namespace
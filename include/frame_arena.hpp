@@ -0,0 +1,62 @@
+#pragma once
+
+#include <span>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+namespace VKFrameArena
+{
+
+constexpr std::size_t DEFAULT_ARENA_SIZE = 256 * 1024;
+
+//  linear allocator for data which lives exactly one frame: draw lists, descriptor lists, lookup tables.
+//  Allocating bumps an offset; the whole arena is released at once by reset, which the renderer calls after the
+//  fence of its frame in flight. A frame which outgrows the arena gets an extra block, and the next reset merges
+//  all blocks into one, so steady frames allocate nothing and the footprint settles at the largest frame
+class FrameArena final
+{
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t                  size;
+    };
+
+    std::vector<Block>         blocks_;
+    std::size_t                 block_ = 0;   //  block allocations come from
+    std::size_t                offset_ = 0;   //  first free byte of that block
+    std::size_t                  used_ = 0;   //  bytes handed out since the last reset, padding included
+    std::size_t                  peak_ = 0;
+
+public:
+
+    explicit FrameArena (std::size_t capacity = DEFAULT_ARENA_SIZE);
+    ~FrameArena() = default;
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    //  default initialized, nothing is destroyed on reset, so only types without destructors fit
+    template <typename T>
+    std::span<T> allocate(std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "frame arena never runs destructors");
+
+        auto* memory = static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+        std::uninitialized_default_construct_n(memory, count);
+
+        return {memory, count};
+    }
+
+    //  everything allocated since the last reset becomes invalid
+    void reset();
+
+    std::size_t get_used    () const { return used_; }
+    std::size_t get_peak    () const { return peak_; }
+    std::size_t get_capacity() const;
+};
+
+}   //  end of VKFrameArena namespace
@@ -0,0 +1,45 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+namespace VKFrustum
+{
+
+//  planes point inside: a point p is in front of a plane when dot(plane.xyz, p) + plane.w >= 0
+class Frustum
+{
+    std::array<glm::vec4, 6> planes_;
+
+public:
+
+    //  Gribb/Hartmann extraction from projection * view, clip depth is [0, 1]
+    explicit Frustum (const glm::mat4& projectionView);
+
+    const std::array<glm::vec4, 6>& get_planes() const { return planes_; }
+};
+
+//  world space bounding spheres laid out by component, so that several of them are tested at once
+struct Spheres
+{
+    std::vector<float>      x;
+    std::vector<float>      y;
+    std::vector<float>      z;
+    std::vector<float> radius;
+
+    void clear() { x.clear(); y.clear(); z.clear(); radius.clear(); }
+    void push_back(const glm::vec3& center, float r) { x.push_back(center.x); y.push_back(center.y); z.push_back(center.z); radius.push_back(r); }
+
+    std::size_t size() const { return x.size(); }
+};
+
+//  visible[i] becomes 1 if sphere i intersects the frustum and 0 otherwise;
+//  spheres are tested 8 at a time with AVX, 4 at a time with SSE, one by one elsewhere
+void cullSpheres(const Frustum& frustum, const Spheres& spheres, std::vector<uint8_t>& visible);
+
+}   //  end of VKFrustum namespace
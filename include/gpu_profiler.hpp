@@ -0,0 +1,114 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "device.hpp"
+#include "swapchain.hpp"
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+namespace VKProfiler
+{
+
+constexpr uint32_t MAX_GPU_SCOPES     =  32;   //  per frame, later scopes are not measured
+constexpr uint32_t GPU_PROFILE_WINDOW = 120;   //  frames the rolling averages are taken over
+constexpr uint32_t INVALID_SCOPE      = ~0u;
+
+//  statistics gathered by scopes which measure them, in the order the query returns them
+constexpr VkQueryPipelineStatisticFlags GPU_STATISTICS = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT   |
+                                                         VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+                                                         VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+                                                         VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT       |
+                                                         VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT |
+                                                         VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+constexpr uint32_t GPU_STATISTIC_COUNT = 6;
+
+//  GPU time of named scopes of the command buffer, measured with timestamp queries written at their ends, plus
+//  pipeline statistics of the outermost scopes asking for them. Every frame in flight has its own query pools;
+//  they are read back without waiting when the frame comes around again, two frames after recording
+class GpuProfiler final
+{
+    struct Scope
+    {
+        const char*   name_;   //  string literal, compared by contents
+        uint32_t     depth_;
+        uint32_t statistic_;   //  query of the pipeline statistics pool, INVALID_SCOPE without
+        bool         ended_;
+    };
+
+    struct Frame
+    {
+        VkQueryPool   timestamps_ = VK_NULL_HANDLE;   //  two queries per scope
+        VkQueryPool   statistics_ = VK_NULL_HANDLE;   //  one query per scope measuring them
+        std::vector<Scope> scopes_;
+        uint32_t  statisticcount_ = 0;
+    };
+
+    struct Sample
+    {
+        float                                               milliseconds = 0.0f;
+        std::array<uint64_t, GPU_STATISTIC_COUNT>               statistics {};
+        bool                                                 hasstatistics = false;
+    };
+
+    //  rolling window of one scope name
+    struct Record
+    {
+        std::string                                 name;
+        uint32_t                                   depth = 0;
+        std::array<Sample, GPU_PROFILE_WINDOW>   samples {};
+        uint32_t                                   count = 0;   //  samples taken so far, the window holds the last ones
+    };
+
+    VKDevice::Device&                                         device_;
+
+    bool                                                    enabled_ = false;   //  graphics queue writes timestamps
+    bool                                              hasstatistics_ = false;
+    float                                           timestampperiod_ = 1.0f;    //  nanoseconds per tick
+    uint64_t                                          timestampmask_ = ~0ull;
+
+    std::array<Frame, VKSwapchain::MAX_FRAMES_IN_FLIGHT>       frames_;
+    Frame*                                                      frame_ = nullptr;
+    uint32_t                                            activestatistic_ = INVALID_SCOPE;   //  statistics queries can not nest
+    uint32_t                                                      depth_ = 0;
+
+    std::vector<Record>                                         records_;
+    std::vector<uint64_t>                                    timestamps_;   //  readback scratch
+    std::vector<uint64_t>                                    statistics_;
+    uint64_t                                               framecount_ = 0;
+
+public:
+
+    GpuProfiler (VKDevice::Device& device);
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    bool is_enabled() const { return enabled_; }
+
+    //  collects the results this frame slot produced last time and resets its queries; outside of a render pass,
+    //  after the fence of the frame was waited for
+    void beginFrame(VkCommandBuffer commandbuffer, uint32_t frameindex);
+
+    //  opens a scope nested in the open ones; statistics are gathered only by the outermost scope asking for them
+    //  and, inside a render pass, only if the scope opens and closes in the same subpass of the primary buffer
+    uint32_t beginScope(VkCommandBuffer commandbuffer, const char* name, bool statistics = false);
+    void       endScope(VkCommandBuffer commandbuffer, uint32_t scope);
+
+    //  rolling averages of every scope seen so far; the format follows the extension, .csv or JSON otherwise
+    void dump(const std::string& filepath) const;
+    void writeJSON(std::ostream& stream) const;
+    void  writeCSV(std::ostream& stream) const;
+
+private:
+    void collect(Frame& frame);
+    Record& record(const char* name, uint32_t depth);
+};
+
+}   //  end of VKProfiler namespace
@@ -35,7 +35,7 @@ public:
     ~Instance();
 
     VkInstance                       get()                                { return instance_; }
-    const std::vector<const char *>& get_extensions()  const      {  return deviceExtensions; }
+    const std::vector<const char *>& get_extensions()  const     {  return deviceExtensions_; }
     bool                             enabledebug()     const { return enableValidationLayers; }
     bool                             enablepresent()   const { return enablePresentationMode; }
     bool                             enableswapchain() const { return        enableSwapChain; }
@@ -56,7 +56,7 @@ private:
 };
 
 void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
-std::vector<const char *> getRequiredExtensions(bool enableValidationLayers);
+std::vector<const char *> getRequiredExtensions(bool enableValidationLayers, bool enableSurface);
 void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger,
                                    const VkAllocationCallbacks *pAllocator);
 bool checkValidationLayerSupport(const std::vector<const char *> &valLayers);
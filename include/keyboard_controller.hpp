@@ -24,7 +24,7 @@ public:
         int lookDown = GLFW_KEY_DOWN;
     };
 
-    void moveInPlaneXZ(GLFWwindow* window, float dt, VKObject::Object& Object);
+    void moveInPlaneXZ(GLFWwindow* window, float dt, VKObject::Transform3Dcomponent& transform);
 
     KeyMappings keys{};
     float moveSpeed{3.f};
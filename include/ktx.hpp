@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <span>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace VKKtx
+{
+
+//  one mip level of a texture, its blocks are tightly packed row by row
+struct Level
+{
+    VkDeviceSize offset = 0;   //  into Texture::data
+    VkDeviceSize   size = 0;
+    uint32_t      width = 0;
+    uint32_t     height = 0;
+};
+
+//  block-compressed 2D texture as stored in a KTX2 file; the blocks go to the GPU as they are
+struct Texture
+{
+    VkFormat                    format = VK_FORMAT_UNDEFINED;
+    uint32_t                     width = 0;
+    uint32_t                    height = 0;
+    std::vector<Level>          levels;   //  level 0 is the full size one
+    std::vector<unsigned char>    data;
+
+    VkDeviceSize getSize() const;
+};
+
+//  bytes of a 4x4 block of the formats known here (BC1, BC7 and ETC2 RGBA), zero for any other
+uint32_t blockSize(VkFormat format);
+
+//  bytes of one level of width x height texels, partial blocks at the edges count as whole ones
+VkDeviceSize levelSize(VkFormat format, uint32_t width, uint32_t height);
+
+//  the compressed file of a texture sits next to the source one: images/wall.png -> images/wall.bc7.ktx2
+std::string compressedPath(const std::string& filepath, VkFormat format);
+
+//  path of the first of the formats, in their order, whose compressed file exists; empty if there is none.
+//  A filepath naming a KTX2 file itself is returned as it is
+std::string findCompressed(const std::string& filepath, std::span<const VkFormat> formats);
+
+//  reads uncompressed (no supercompression) 2D KTX2 files of the formats above; throws on anything else
+Texture read(const std::string& filepath);
+
+//  writes texture with a basic data format descriptor and without key/value data
+void write(const std::string& filepath, const Texture& texture);
+
+//  2x2 box filter of an RGBA8 sRGB image, colour is averaged in linear space, odd edges are clamped
+void downsampleSRGB(const unsigned char* src, int width, int height, std::vector<unsigned char>& dst);
+
+}   //  end of VKKtx namespace
@@ -0,0 +1,70 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace VKMeshCache
+{
+
+//  bumped whenever the layout of the file or of the cached vertices changes
+constexpr uint32_t MESH_CACHE_VERSION = 1;
+
+//  .vkmesh layout: header, vertexcount vertices of vertexsize bytes, indexcount uint32_t indices
+struct MeshHeader
+{
+    char              magic[8] = {'V', 'K', 'M', 'E', 'S', 'H', '\0', '\0'};
+    uint32_t           version =                         MESH_CACHE_VERSION;
+    uint32_t        vertexsize =                                          0;
+
+    uint64_t        sourcesize =                                          0;
+    int64_t         sourcetime =                                          0;
+    uint64_t        sourcehash =                                          0;     //  FNV-1a of the obj file
+
+    uint64_t       vertexcount =                                          0;
+    uint64_t        indexcount =                                          0;
+
+    glm::vec3        boundsmin {0.0f};
+    glm::vec3        boundsmax {0.0f};
+};
+
+//  path of the cache file belonging to a source mesh
+std::string cachePath(const std::string& filepath_to_model);
+
+//  read-only memory mapping of a valid cache file
+class MappedMesh final
+{
+    void*           data_ = nullptr;
+    std::size_t     size_ =       0;
+
+    MappedMesh(void* data, std::size_t size) : data_{data}, size_{size} {}
+
+public:
+
+    ~MappedMesh();
+
+    MappedMesh(const MappedMesh&) = delete;
+    MappedMesh& operator=(const MappedMesh&) = delete;
+
+    //  nullptr if the cache is missing, damaged, of another version or vertex layout, or older than the source
+    static std::unique_ptr<MappedMesh> open(const std::string& cachepath, const std::string& filepath_to_model, uint32_t vertexsize);
+
+    const MeshHeader& header  () const { return *static_cast<const MeshHeader *>(data_); }
+    const void*       vertices() const { return static_cast<const char *>(data_) + sizeof(MeshHeader); }
+    const uint32_t*   indices () const
+    {
+        return reinterpret_cast<const uint32_t *>(static_cast<const char *>(vertices()) + header().vertexcount * header().vertexsize);
+    }
+};
+
+//  writes the cache next to its source through a temporary file, so readers never see a half written one;
+//  returns false if the cache could not be written (e.g. read-only asset directory)
+bool write(const std::string& cachepath, const std::string& filepath_to_model, uint32_t vertexsize,
+           const void* vertices, uint64_t vertexcount, const uint32_t* indices, uint64_t indexcount,
+           const glm::vec3& boundsmin, const glm::vec3& boundsmax);
+
+}   //  end of VKMeshCache namespace
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <span>
 #include <memory>
 
 #define GLFW_INCLUDE_VULKAN
@@ -10,7 +11,10 @@
 #include <glm/glm.hpp>
 
 #include "device.hpp"
+#include "mesh_cache.hpp"
+#include "thread_pool.hpp"
 #include "buffmanager.hpp"
+#include "ktx.hpp"
 
 
 namespace VKModel
@@ -28,11 +32,20 @@ class Model final
     uint32_t indexcount_ = 0;
 
     VkImage             textureimg_ = VK_NULL_HANDLE;
-    VkDeviceMemory   textureimgmem_ = VK_NULL_HANDLE;
+    VKAllocator::Allocation textureimgmem_{};
     uint32_t       textureimgcount_ =              0;
+    VkFormat         textureformat_ = VK_FORMAT_R8G8B8A8_SRGB;
+    uint32_t             miplevels_ =              1;
+    VkDeviceSize       texturesize_ =              0;
 
     VkImageView     textureimgview_ = VK_NULL_HANDLE;
     VkSampler       texturesampler_ = VK_NULL_HANDLE;
+    uint32_t          textureindex_ =              0;   //  element of the bindless texture array, the fallback one if untextured
+
+    uint64_t          uploadticket_ =              0;
+
+    glm::vec3         boundscenter_ {0.0f};    //  bounding sphere in model space, for culling
+    float             boundsradius_ =           0.0f;
 
 public:
 
@@ -57,9 +70,24 @@ public:
         std::vector<Vertex>   vertices{};
         std::vector<uint32_t>  indices{};
 
+        glm::vec3            boundsmin{0.0f};
+        glm::vec3            boundsmax{0.0f};
+
+        //  set when the mesh comes from a .vkmesh cache; vertices and indices stay empty then
+        //  and the data is read straight from the mapping
+        std::shared_ptr<const VKMeshCache::MappedMesh> mapping;
+
         std::string  filepath_to_texture;
 
-        void load_models (const std::string& filepath_to_model);
+        //  loads the mesh from its binary cache if it is up to date, otherwise parses the obj and writes the cache;
+        //  with a pool the deduplication of big meshes is split over its threads
+        void load_models (const std::string& filepath_to_model, VKThreadPool::ThreadPool* pool = nullptr);
+
+        std::span<const Vertex>   get_vertices() const;
+        std::span<const uint32_t>  get_indices() const;
+
+    private:
+        void parse_obj (const std::string& filepath_to_model, VKThreadPool::ThreadPool* pool);
     };
 
     Model (VKDevice::Device& device, const VKModel::Model::Builder& builder);
@@ -73,18 +101,43 @@ public:
                                                                                 const std::string& filepath_to_texture);
 
     void bind(VkCommandBuffer commandbuffer);
-    void draw(VkCommandBuffer commandbuffer);
+    void draw(VkCommandBuffer commandbuffer, uint32_t instancecount = 1, uint32_t firstinstance = 0);
+
+    //  one indirect draw read from commandbuffer at offset; with a count buffer it is skipped when the count is zero
+    void drawIndirect(VkCommandBuffer commandbuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countbuffer, VkDeviceSize countoffset);
+
+    bool     hasIndices    () const { return hasindexbuffer; }
+    uint32_t getVertexCount() const { return   vertexcount_; }
+    uint32_t getIndexCount () const { return    indexcount_; }
 
     VkImageView getimgview() { return textureimgview_; }
     VkSampler   getsampler() { return texturesampler_; }
     bool has_texture() { return textureimg_ != VK_NULL_HANDLE; }
+    uint32_t getTextureIndex() const { return textureindex_; }
+
+    const glm::vec3& getBoundsCenter() const { return boundscenter_; }
+    float            getBoundsRadius() const { return boundsradius_; }
+
+    //  false while vertices, indices or texture are still on their way to the GPU
+    bool isReady() const;
+
+    //  streamed textures: the image is created and its upload recorded, the returned ticket tells when it is done;
+    //  until publishTexture the model keeps drawing with the fallback texture
+    uint64_t uploadTexture (const unsigned char* pixels, int width, int height);
+    uint64_t uploadTexture (const VKKtx::Texture& texture);
+    void     publishTexture();
+
+    //  amount of device memory occupied by vertices, indices and texture of the model
+    VkDeviceSize getMemorySize() const;
 
 private:
     void createTextureImage(const std::string& filepath);
+    void createTextureImage(const unsigned char* pixels, int texWidth, int texHeight);
+    void createTextureImage(const VKKtx::Texture& texture);
     void createTextureImageView();
     void createTextureSampler();
-    void createVertexBuffer(const std::vector<Vertex>& vertices);
-    void  createIndexBuffer(const std::vector<uint32_t>& indices);
+    void createVertexBuffer(std::span<const Vertex> vertices);
+    void  createIndexBuffer(std::span<const uint32_t> indices);
 };
 
 }   //  end of the VKModel namespace
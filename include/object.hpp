@@ -13,6 +13,7 @@
 namespace VKObject
 {
 
+//  transform of a single object; the ones of the scene are kept by VKTransformSystem::TransformSystem
 struct Transform3Dcomponent
 {
     glm::vec3 translation{};    //  offest translation
@@ -45,9 +46,9 @@ public:
 
     const id_t get_id() const { return id_; }
 
+    //  transform lives in the TransformSystem under get_id()
     std::shared_ptr<VKModel::Model> model_{};
     glm::vec3                       color_{};
-    Transform3Dcomponent      transform3D_{};
 
     bool has_material() { return model_->has_texture(); }
 };
@@ -18,6 +18,7 @@ namespace VKPipeline
 
 const std::string VERT_SHADER_FILE_NAME = "../../src/src/shader/vert.spv";
 const std::string FRAG_SHADER_FILE_NAME = "../../src/src/shader/frag.spv";
+const std::string CULL_SHADER_FILE_NAME = "../../src/src/shader/cull.spv";
 
 struct PipelineConfigInfo 
 {
@@ -25,6 +26,9 @@ struct PipelineConfigInfo
     PipelineConfigInfo(const PipelineConfigInfo&)            =  delete;
     PipelineConfigInfo& operator=(const PipelineConfigInfo&) =  delete;
 
+    std::vector<VkVertexInputBindingDescription>   bindingDescriptions{};
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
     VkPipelineViewportStateCreateInfo                     viewportInfo;
     VkPipelineInputAssemblyStateCreateInfo           inputAssemblyInfo;
     VkPipelineRasterizationStateCreateInfo           rasterizationInfo;
@@ -46,6 +50,7 @@ class Pipeline final
 {
 
     VkDevice                   device_ = VK_NULL_HANDLE;
+    VkPipelineCache     pipelinecache_ = VK_NULL_HANDLE;
     VkRenderPass           renderpass_ = VK_NULL_HANDLE;
 
     VkShaderModule   vertshadermodule_ = VK_NULL_HANDLE;
@@ -71,4 +76,26 @@ public:
     static void defaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
 };
 
+class ComputePipeline final
+{
+
+    VkDevice                   device_ = VK_NULL_HANDLE;
+    VkPipelineCache     pipelinecache_ = VK_NULL_HANDLE;
+
+    VkShaderModule       shadermodule_ = VK_NULL_HANDLE;
+    VkPipeline        computepipeline_ = VK_NULL_HANDLE;
+
+public:
+
+    ComputePipeline (VKDevice::Device& device, const std::string& shaderpath, VkPipelineLayout pipelineLayout);
+    ~ComputePipeline();
+
+    ComputePipeline(const ComputePipeline&) = delete;
+    ComputePipeline& operator=(const ComputePipeline&) = delete;
+
+    void bind(VkCommandBuffer commandBuffer);
+};
+
+VkShaderModule createShaderModule(const std::vector<char>& code, const VkDevice& device);
+
 }   //  end of VKPipeline namespace
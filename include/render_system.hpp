@@ -4,21 +4,93 @@
 #include "object.hpp"
 #include "pipeline.hpp"
 #include "camera.hpp"
+#include "buffmanager.hpp"
+#include "swapchain.hpp"
+#include "frustum.hpp"
+#include "descriptors.hpp"
+#include "thread_pool.hpp"
+#include "transform_system.hpp"
+#include "frame_arena.hpp"
 
 // std
+#include <span>
+#include <array>
 #include <memory>
 #include <vector>
 
 namespace VKRenderSystem
 {
 
+//  fewer batches than this per thread are recorded faster inline than handed to secondary command buffers
+constexpr uint32_t MIN_BATCHES_PER_RECORDER = 32;
+
+//  objects sharing the same model are drawn with a single instanced call
+struct DrawBatch
+{
+    VKModel::Model*  model_;
+    uint32_t firstinstance_;
+    uint32_t instancecount_;
+};
+
+//  everything transient a frame carries lives in its arena and is only referenced from here
 struct FrameInfo
 {
     int  frameindex_;
     float frametime_;
     VkCommandBuffer                     commandbuffer_;
     VKCamera::Camera&                          camera_;
-    std::vector<VkDescriptorSet> globaldescriptorsets_;
+    VKFrameArena::FrameArena&                   arena_;
+    std::span<const VkDescriptorSet>   descriptorsets_;   //  bound from set 0 on by every draw
+    std::span<const uint32_t>          dynamicoffsets_;   //  one per dynamic buffer of those sets, in binding order
+    std::span<DrawBatch>                      batches_ {};   //  draw list, filled by cullObjects
+};
+
+//  per-instance vertex attributes, consumed through the second vertex binding
+struct InstanceData
+{
+    glm::mat4  modelMatrix{1.f};
+    glm::mat4 normalMatrix{1.f};
+    uint32_t  textureindex = 0;   //  element of the bindless texture array
+    uint32_t    padding[3] {};
+
+    static std::vector<VkVertexInputBindingDescription>     get_binding_descriptions();
+    static std::vector<VkVertexInputAttributeDescription> get_attribute_descriptions();
+};
+
+//  object record read by the culling shader, std430 layout of ObjectData in cull.comp; the matrices are the cached ones
+//  of the transform system, so a record is rewritten only when its transform changed
+struct CullObject
+{
+    glm::mat4  modelMatrix;
+    glm::mat4 normalMatrix;
+    glm::vec4       bounds;  //  model space center, radius scaled by the largest scale component
+    uint32_t         batch;
+    uint32_t    padding[3];
+};
+
+//  indirect command of a batch followed by the start of its instance range, layout of Batch in cull.comp;
+//  the shader counts the visible instances into instanceCount, which sits at the same offset in both commands
+struct IndirectBatch
+{
+    union
+    {
+        VkDrawIndexedIndirectCommand indexed;
+        VkDrawIndirectCommand          plain;
+    } command;
+
+    uint32_t          base;
+    uint32_t  textureindex;   //  shared by every instance of the model
+    uint32_t       padding;
+};
+
+static_assert(sizeof(InstanceData)  == 144, "InstanceData has to match InstanceData of cull.comp");
+static_assert(sizeof(CullObject)    == 160, "CullObject has to match ObjectData of cull.comp");
+static_assert(sizeof(IndirectBatch) ==  32, "IndirectBatch has to match Batch of cull.comp");
+
+struct CullPush
+{
+    glm::vec4      planes[6];
+    uint32_t     objectcount;
 };
 
 class RenderSystem 
@@ -29,6 +101,46 @@ class RenderSystem
     std::unique_ptr<VKPipeline::Pipeline> pipeline_;
     VkPipelineLayout                pipelineLayout_;
 
+    std::array<std::unique_ptr<VKBuffmanager::Buffmanager>, VKSwapchain::MAX_FRAMES_IN_FLIGHT> instancebuffs_;
+
+    //  per frame scratch of the frustum test, parallel to each other; kept to reuse their storage
+    VKFrustum::Spheres                                  spheres_;
+    std::vector<uint8_t>                                visible_;
+
+    //  GPU-driven path: a compute pass culls and fills the instance ranges, batches are drawn indirectly;
+    //  used when cull.spv is available and the device takes a first instance from indirect commands
+    struct CullFrame
+    {
+        std::unique_ptr<VKBuffmanager::Buffmanager>    objectbuff_;
+        std::unique_ptr<VKBuffmanager::Buffmanager>     batchbuff_;
+        std::unique_ptr<VKBuffmanager::Buffmanager>     countbuff_;
+        std::unique_ptr<VKBuffmanager::Buffmanager>  instancebuff_;
+        VkDescriptorSet                         set_ = VK_NULL_HANDLE;
+
+        uint64_t                            version_ = 0;   //  grouping the records were written for
+        std::vector<uint32_t>                       pending_;   //  transform ids changed since the records were written
+        std::vector<uint8_t>                         marked_;   //  per transform id, set while it is in pending_
+    };
+
+    bool                                            gpuculling_ = false;
+    VkPipelineLayout                          cullpipelinelayout_ = VK_NULL_HANDLE;
+    std::unique_ptr<VKDescriptors::DescriptorSetLayout> cullsetlayout_;
+    std::unique_ptr<VKDescriptors::DescriptorPool>          cullpool_;
+    std::unique_ptr<VKPipeline::ComputePipeline>        cullpipeline_;
+    std::array<CullFrame, VKSwapchain::MAX_FRAMES_IN_FLIGHT> cullframes_;
+
+    //  the GPU path keeps its grouping in scenebatches_ across frames and builds it again only when an object was added,
+    //  removed or given another model, or a waiting model finished uploading; a steady frame rewrites the records
+    //  of the objects the transform system updated and nothing else
+    std::vector<DrawBatch>                           scenebatches_;   //  instance counts are the capacities of the ranges
+    std::vector<VKModel::Model*>                       scenemodels_;   //  model of every object when the grouping was built
+    std::vector<uint32_t>                                 sceneids_;   //  transform id of every object at the same time
+    std::vector<uint32_t>                             sceneobjects_;   //  object index of every record
+    std::vector<uint32_t>                              recordbatch_;   //  batch of every record
+    std::vector<uint32_t>                               recordofid_;   //  record of every transform id
+    std::vector<uint32_t>                                  waiting_;   //  objects whose model is still uploading
+    uint64_t                                          sceneversion_ = 0;
+
 public:
     RenderSystem(VKDevice::Device &device, VkRenderPass renderPass, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts);
     ~RenderSystem();
@@ -36,11 +148,36 @@ public:
     RenderSystem(const RenderSystem &) = delete;
     RenderSystem &operator=(const RenderSystem &) = delete;
 
-    void renderObjects(FrameInfo& frameinfo, std::vector<VKObject::Object> &Objects);
+    //  decides what is drawn this frame and leaves the draw list in frameinfo; records the culling dispatch on the GPU path,
+    //  so it goes before the render pass. Matrices are read from transforms, which has to be updated already
+    void cullObjects(FrameInfo& frameinfo, std::vector<VKObject::Object> &Objects, const VKTransformSystem::TransformSystem& transforms);
+    //  draws the draw list of frameinfo, inside the render pass
+    void renderObjects(FrameInfo& frameinfo);
+    //  same split over secondary command buffers: every one gets a contiguous range of batches and is recorded
+    //  by its own thread of the pool, so executing them in order keeps the draw order of the inline path
+    void renderObjects(FrameInfo& frameinfo, const std::vector<VkCommandBuffer>& secondaries, VKThreadPool::ThreadPool& pool);
+
+    //  how many secondary command buffers the batches of this frame are worth with threadcount threads; below 2 render inline
+    uint32_t recorderCount(const FrameInfo& frameinfo, std::size_t threadcount) const;
+
+    bool usesGPUCulling() const { return gpuculling_; }
 
 private:
     void createPipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts);
     void createPipeline(VkRenderPass renderPass);
+    void createCullPipeline();
+
+    void cullOnCPU(FrameInfo& frameinfo, std::vector<VKObject::Object> &objects, const VKTransformSystem::TransformSystem& transforms);
+    void cullOnGPU(FrameInfo& frameinfo, std::vector<VKObject::Object> &objects, const VKTransformSystem::TransformSystem& transforms);
+
+    bool sceneChanged(const std::vector<VKObject::Object> &objects) const;
+    void rebuildScene(VKFrameArena::FrameArena& arena, const std::vector<VKObject::Object> &objects, const VKTransformSystem::TransformSystem& transforms);
+    void writeRecord (CullObject& record, const VKObject::Object& object, uint32_t batch, const VKTransformSystem::TransformSystem& transforms);
+
+    void recordBatches(VkCommandBuffer commandbuffer, const FrameInfo& frameinfo, uint32_t firstbatch, uint32_t lastbatch);
+
+    void reserveInstances(int frameindex, uint32_t instancecount);
+    void reserveCullFrame(int frameindex, uint32_t objectcount, uint32_t batchcount);
 
 };
 
@@ -3,13 +3,18 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include <array>
+#include <chrono>
 #include <memory>
+#include <vector>
 #include <cassert>
 
 #include "device.hpp"
 #include "pipeline.hpp"
 #include "swapchain.hpp"
 #include "object.hpp"
+#include "gpu_profiler.hpp"
+#include "frame_arena.hpp"
 
 namespace VKRenderer
 {
@@ -22,12 +27,30 @@ class Renderer final
     std::unique_ptr<VKSwapchain::Swapchain> swapchain_;
     std::vector<VkCommandBuffer>        commandbuffer_;
 
-    uint32_t                    currentImageIndex_ = 0;
+    //  one pool per recording thread and frame in flight, so threads never share a pool and a frame resets its pools at once
+    struct Recorder
+    {
+        VkCommandPool     commandpool_ = VK_NULL_HANDLE;
+        VkCommandBuffer commandbuffer_ = VK_NULL_HANDLE;
+    };
+    std::array<std::vector<Recorder>, VKSwapchain::MAX_FRAMES_IN_FLIGHT> recorders_;
+    std::vector<VkCommandBuffer>                                       secondaries_;   //  begun in the current frame
+    std::array<VKFrameArena::FrameArena, VKSwapchain::MAX_FRAMES_IN_FLIGHT>   arenas_;   //  reset together with the recorders
+
+    uint32_t                    currentImageIndex_ = 0;   //  swapchain image the frame renders to
+    uint32_t                    currentFrameIndex_ = 0;   //  frame in flight, selects per frame resources
+    uint32_t                       lastImageIndex_ = 0;   //  image of the last submitted frame
     bool                       isFrameStarted_ = false;
 
+    VKSwapchain::PresentPolicy                 policy_;
+    VKProfiler::GpuProfiler                  profiler_;
+    uint32_t          framescope_ = VKProfiler::INVALID_SCOPE;   //  whole command buffer of the frame
+    uint32_t     renderpassscope_ = VKProfiler::INVALID_SCOPE;
+    std::chrono::steady_clock::time_point   nextframe_;   //  earliest start of the next frame under a frame rate cap
+
 public:
 
-    Renderer (VKWindow::Window& window, VKDevice::Device& device);
+    Renderer (VKWindow::Window& window, VKDevice::Device& device, const VKSwapchain::PresentPolicy& policy = VKSwapchain::PresentPolicy{});
     ~Renderer();
 
     //  functions for setting frames before drawing
@@ -40,20 +63,47 @@ public:
     {
         assert (isFrameStarted_ && "Cannot get commandbuffer while the frame is not processing");
 
-        return commandbuffer_[currentImageIndex_];
+        return commandbuffer_[currentFrameIndex_];
     }
 
-    //  functions for setting renderpass
-    void beginSwapchainRenderpass(VkCommandBuffer commandBuffer);
+    //  functions for setting renderpass; with secondary contents the pass is filled by executeSecondaryCommandBuffers only
+    void beginSwapchainRenderpass(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
     void   endSwapchainRenderpass(VkCommandBuffer commandBuffer);
+
+    //  begins count secondary command buffers continuing the swapchain render pass, viewport and scissor already set;
+    //  each of them may be recorded by a different thread. The render pass has to be begun with secondary contents
+    const std::vector<VkCommandBuffer>& beginSecondaryCommandBuffers(uint32_t count);
+    //  ends the secondaries and executes them from the primary in the order they were handed out
+    void executeSecondaryCommandBuffers(VkCommandBuffer commandBuffer);
     VkRenderPass getSwapChainRenderPass() const { return swapchain_->get_renderpass(); }
     float getAspectRatio () const { return swapchain_->extentAspectRatio(); }
-    uint32_t getframeindex() const { return currentImageIndex_; }
+    uint32_t getframeindex() const { return currentFrameIndex_; }
+
+    //  transient memory of the current frame, valid until the frame slot comes around again
+    VKFrameArena::FrameArena& getFrameArena()
+    {
+        assert (isFrameStarted_ && "Cannot get frame arena while the frame is not processing");
+
+        return arenas_[currentFrameIndex_];
+    }
+
+    //  a new present mode or image count recreates the swapchain in place, a new frame rate cap applies to the next frame
+    void setPresentPolicy(const VKSwapchain::PresentPolicy& policy);
+    const VKSwapchain::PresentPolicy& getPresentPolicy() const { return policy_; }
+    VkPresentModeKHR                  getPresentMode  () const { return swapchain_->get_present_mode(); }
+
+    //  scopes of the frame and of the swapchain render pass are opened here, callers may nest their own inside
+    VKProfiler::GpuProfiler& getProfiler() { return profiler_; }
+
+    //  headless only: writes the last submitted frame to a PPM file
+    void captureFrame(const std::string& filepath) { swapchain_->captureImage(lastImageIndex_, filepath); }
 
 private:
     void createCommandBuffers();
     void recreateSwapChain();
+    void paceFrame();
     void freeCommandBuffers();
+    void destroyRecorders();
 };
 
 }   //  end of the VKRenderer namespace
@@ -4,6 +4,7 @@
 #include <GLFW/glfw3.h>
 
 #include <array>
+#include <string>
 #include <vector>
 #include <memory>
 
@@ -13,6 +14,25 @@ namespace VKSwapchain
 {
 
 constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+constexpr VkFormat OFFSCREEN_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;   //  color format of headless frames, byte order of PPM
+
+//  how finished frames reach the screen; every mode falls back to FIFO, the only one a surface has to support
+enum class PresentMode
+{
+    LowLatency,     //  mailbox: the newest frame replaces the queued one, no tearing; immediate before the fallback
+    Immediate,      //  no waiting for vertical blank at all, frames may tear; mailbox before the fallback
+    VSync,          //  fifo: locked to the refresh rate, the GPU idles between frames
+    AdaptiveVSync,  //  fifo relaxed: like vsync, but a late frame is shown at once instead of a refresh later
+};
+
+constexpr int PRESENT_MODE_COUNT = 4;
+
+struct PresentPolicy
+{
+    PresentMode mode       = PresentMode::LowLatency;
+    uint32_t    imagecount =    0;    //  swapchain images to request, clamped to the surface limits; zero is one above its minimum
+    float       maxfps     = 0.0f;    //  Renderer sleeps to hold frames at this rate; zero is uncapped
+};
 
 struct SwapChainSupportDetails 
 {
@@ -26,16 +46,20 @@ class Swapchain final
     VkSurfaceKHR                                 surface_;
     VKDevice::Device&                             device_;
     
-    VkSwapchainKHR                             swapchain_;
+    VkSwapchainKHR            swapchain_ = VK_NULL_HANDLE;  //  stays null without a surface, frames go to own images
     std::shared_ptr<Swapchain>              oldswapchain_;  //  for swapchain recreation
 
+    PresentPolicy                                 policy_;
+    VkPresentModeKHR    presentmode_ = VK_PRESENT_MODE_FIFO_KHR;  //  what the policy resolved to on this surface
+
     VkRenderPass                              renderpass_;
     
     std::vector<VkImage>                 swapchainimages_;
     std::vector<VkImageView>         swapchainimageviews_;
+    std::vector<VKAllocator::Allocation> offscreenmemorys_;
 
     std::vector<VkImage>                     depthimages_;
-    std::vector<VkDeviceMemory>        depthimagememorys_;
+    std::vector<VKAllocator::Allocation> depthimagememorys_;
     std::vector<VkImageView>             depthimageviews_;
 
     VkFormat                        swapchainimageformat_;
@@ -52,8 +76,9 @@ class Swapchain final
 
 public:
 
-    Swapchain (VKWindow::Window& window, VKDevice::Device& device);
-    Swapchain (VKWindow::Window& window, VKDevice::Device& device, std::shared_ptr<Swapchain> previous);
+    Swapchain (VKWindow::Window& window, VKDevice::Device& device, const PresentPolicy& policy = PresentPolicy{});
+    Swapchain (VKWindow::Window& window, VKDevice::Device& device, std::shared_ptr<Swapchain> previous,
+               const PresentPolicy& policy = PresentPolicy{});
 
     ~Swapchain();
 
@@ -64,6 +89,12 @@ public:
     VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
 
     size_t imageCount() { return swapchainimages_.size(); }
+    bool is_offscreen() const { return surface_ == VK_NULL_HANDLE; }
+
+    VkPresentModeKHR get_present_mode() const { return presentmode_; }
+
+    //  waits for the GPU and writes the offscreen image as binary PPM
+    void captureImage(uint32_t imageIndex, const std::string& filepath);
 
     //  functions of connection
     VkSwapchainKHR        get_swapchain()       { return swapchain_; }
@@ -91,14 +122,12 @@ public:
 
 private:
     void createSwapChain(VKWindow::Window& window);
+    void createOffscreenImages(VKWindow::Window& window);
     void createImageViews();
     void createRenderPass();
     void createDepthResources();
     void createFramebuffers();
     void createSyncObjects();
-
-    void createImageWithInfo (const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties,
-                                    VkImage &image, VkDeviceMemory &imageMemory);
 };
 
 VkFormat findDepthFormat(VkPhysicalDevice device);
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "device.hpp"
+#include "model.hpp"
+#include "thread_pool.hpp"
+#include "upload_context.hpp"
+#include "ktx.hpp"
+
+#include <future>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace VKTextureLoader
+{
+
+//  bytes of decoded texels staged per frame; one texture always goes, however big it is
+constexpr VkDeviceSize UPLOAD_BUDGET_PER_FRAME = VKUpload::STAGING_FRAME_SIZE / 2;
+
+//  RGBA8 texels as the decoder returned them, or the blocks of a compressed file found next to the image
+struct Image
+{
+    std::unique_ptr<unsigned char, void (*)(void*)> pixels {nullptr, nullptr};
+    int                                              width = 0;
+    int                                             height = 0;
+
+    VKKtx::Texture                              compressed;   //  used if pixels is empty
+};
+
+//  decodes textures on the worker pool while their models are drawn with the fallback texture of the bindless array.
+//  Decoded images are staged through the upload ring on the render thread, a few per frame, and a model switches
+//  over to its texture once the upload is visible to the graphics queue. Models dropped meanwhile are skipped
+class TextureLoader final
+{
+public:
+    //  called on the render thread for every model which has just switched to its texture
+    using PublishCallback = std::function<void (const VKModel::Model& model)>;
+
+private:
+    struct Decode
+    {
+        std::weak_ptr<VKModel::Model>       model_;
+        std::future<Image>                  image_;
+    };
+
+    struct Upload
+    {
+        std::weak_ptr<VKModel::Model>       model_;
+        uint64_t                           ticket_;
+    };
+
+    VKDevice::Device&                      device_;
+    VKThreadPool::ThreadPool&                pool_;
+
+    std::vector<Decode>                  decoding_;   //  in request order
+    std::vector<Upload>                 uploading_;
+
+    PublishCallback                     published_;
+
+public:
+
+    TextureLoader (VKDevice::Device& device, VKThreadPool::ThreadPool& pool) : device_{device}, pool_{pool} {}
+    ~TextureLoader() = default;
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    //  the model has to be untextured, it keeps the fallback texture until this one is resident
+    void request(const std::shared_ptr<VKModel::Model>& model, const std::string& filepath);
+
+    //  render thread, once per frame ahead of the upload submit: publishes finished uploads and records the uploads
+    //  of decoded images within the budget. Decoding errors are rethrown here
+    void update();
+
+    //  waits until every requested texture is resident, for runs which must not see placeholders
+    void flush();
+
+    //  e.g. for the asset registry to account the texture memory of streamed models; empty callback removes it
+    void setPublishCallback(PublishCallback callback) { published_ = std::move(callback); }
+
+    std::size_t getPendingCount() const { return decoding_.size() + uploading_.size(); }
+};
+
+}   //  end of VKTextureLoader namespace
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <exception>
+#include <type_traits>
+#include <condition_variable>
+
+namespace VKThreadPool
+{
+
+class ThreadPool final
+{
+    //  range of a parallel_for; there is one per pool, so handing out a range allocates nothing
+    struct Job
+    {
+        void                      (*invoke)(void*, std::size_t) = nullptr;   //  calls the type erased body
+        void*                       body = nullptr;
+        std::size_t                count = 0;
+        std::atomic<std::size_t>    next {0};
+        std::atomic<std::size_t>    done {0};
+        std::size_t              helpers = 0;   //  workers inside the range, guarded by mutex_
+        std::exception_ptr         error;
+    };
+
+    std::vector<std::thread>                workers_;
+    std::deque<std::function<void()>>         tasks_;
+    std::mutex                                mutex_;
+    std::condition_variable               condition_;
+    std::condition_variable                finished_;   //  signals the caller of parallel_for
+    bool                               stopping_ = false;
+
+    Job                                         job_;
+    bool                                  jobactive_ = false;
+
+public:
+
+    //  zero means one worker per hardware thread except the calling one
+    explicit ThreadPool (std::size_t threadcount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const { return workers_.size(); }
+
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        auto future   =                                              packaged->get_future();
+
+        enqueue([packaged] { (*packaged)(); });
+        return future;
+    }
+
+    //  calls body(i) for every i in [0, count), the calling thread works on the range too; the first exception is
+    //  rethrown here. Only one range runs at a time: a parallel_for issued while another one is running, nested ones
+    //  from inside the body included, is worked off by its calling thread alone, so it can not deadlock either
+    template <typename F>
+    void parallel_for(std::size_t count, F&& body)
+    {
+        if (count == 0)
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock {mutex_};
+            if (jobactive_)
+            {
+                lock.unlock();
+                for (std::size_t i = 0; i < count; ++i)
+                    body(i);
+                return;
+            }
+
+            job_.invoke  = [](void* erased, std::size_t i) { (*static_cast<std::remove_reference_t<F>*>(erased))(i); };
+            job_.body    = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+            job_.count   =                                                                 count;
+            job_.next    =                                                                     0;
+            job_.done    =                                                                     0;
+            job_.helpers =                                                                     0;
+            job_.error   =                                                               nullptr;
+            jobactive_   =                                                                  true;
+        }
+        if (count > 1)
+            condition_.notify_all();
+
+        runJob();
+
+        std::exception_ptr error;
+        {
+            //  helpers still inside the range touch job_, it is released only after the last of them left
+            std::unique_lock<std::mutex> lock {mutex_};
+            finished_.wait(lock, [this] { return job_.done == job_.count && job_.helpers == 0; });
+
+            jobactive_ =                  false;
+            error      = std::move(job_.error);
+        }
+
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+private:
+    void enqueue(std::function<void()> task);
+    void work();
+    void runJob();
+};
+
+}   //  end of VKThreadPool namespace
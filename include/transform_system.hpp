@@ -0,0 +1,110 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include "object.hpp"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+namespace VKTransformSystem
+{
+
+//  vectors of many transforms laid out by component, so that several of them are loaded at once
+struct Components
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> z;
+
+    void clear() { x.clear(); y.clear(); z.clear(); }
+    void push_back(const glm::vec3& value) { x.push_back(value.x); y.push_back(value.y); z.push_back(value.z); }
+    void resize(std::size_t count, const glm::vec3& value) { x.resize(count, value.x); y.resize(count, value.y); z.resize(count, value.z); }
+
+    glm::vec3 get(std::size_t index) const                   { return glm::vec3{x[index], y[index], z[index]}; }
+    void      set(std::size_t index, const glm::vec3& value) { x[index] = value.x; y[index] = value.y; z[index] = value.z; }
+
+    std::size_t size() const { return x.size(); }
+};
+
+//  world matrix, normal matrix and largest absolute scale component of every transform, YXZ rotation order;
+//  translations, rotations and scales have to be of the same size and every output has room for that many entries.
+//  Transforms are composed 8 at a time with AVX2, 4 at a time with SSE2, one by one elsewhere
+void composeMatrices(const Components& translations, const Components& rotations, const Components& scales,
+                     glm::mat4* worlds, glm::mat4* normals, float* maxscales);
+
+//  transforms of all objects laid out by component and indexed by object id. World and normal matrices
+//  are cached and recomputed by update() only for entries touched since the last one, so static objects cost nothing
+class TransformSystem final
+{
+    Components              translations_;
+    Components                 rotations_;
+    Components                    scales_;
+
+    std::vector<glm::mat4>        worlds_;
+    std::vector<glm::mat4>       normals_;   //  inverse transpose of the upper 3x3, widened for the instance data
+    std::vector<float>         maxscales_;   //  largest absolute scale component, scales bounding radii
+
+    std::vector<uint8_t>           dirty_;
+    std::vector<uint32_t>      dirtylist_;
+    std::vector<uint32_t>        updated_;   //  ids recomputed by the last update()
+
+    //  dirty entries packed for composeMatrices, kept to reuse their storage
+    Components        packedtranslations_;
+    Components           packedrotations_;
+    Components              packedscales_;
+    std::vector<glm::mat4>  packedworlds_;
+    std::vector<glm::mat4> packednormals_;
+    std::vector<float>   packedmaxscales_;
+
+public:
+
+    TransformSystem() = default;
+
+    TransformSystem(const TransformSystem&) = delete;
+    TransformSystem& operator=(const TransformSystem&) = delete;
+
+    //  sets the whole transform, entries between the last id and this one are created as identity
+    void set(uint32_t id, const VKObject::Transform3Dcomponent& transform);
+
+    //  set one component, an id not created yet is created like set() does, with the other components of the identity
+    void setTranslation(uint32_t id, const glm::vec3& translation) { grow(id); translations_.set(id, translation); markDirty(id); }
+    void setRotation   (uint32_t id, const glm::vec3&    rotation) { grow(id);    rotations_.set(id,    rotation); markDirty(id); }
+    void setScale      (uint32_t id, const glm::vec3&       scale) { grow(id);       scales_.set(id,       scale); markDirty(id); }
+
+    glm::vec3 getTranslation(uint32_t id) const { return translations_.get(id); }
+    glm::vec3 getRotation   (uint32_t id) const { return    rotations_.get(id); }
+    glm::vec3 getScale      (uint32_t id) const { return       scales_.get(id); }
+
+    //  valid after update()
+    const glm::mat4& getWorld   (uint32_t id) const { return    worlds_[id]; }
+    const glm::mat4& getNormal  (uint32_t id) const { return   normals_[id]; }
+    float            getMaxScale(uint32_t id) const { return maxscales_[id]; }
+
+    //  ids whose matrices the last update() recomputed, for consumers which mirror the matrices elsewhere
+    std::span<const uint32_t> getUpdated() const { return updated_; }
+
+    bool        contains(uint32_t id) const { return id < translations_.size(); }
+    std::size_t size    ()            const { return translations_.size(); }
+
+    //  recomputes the cached matrices of dirty entries in one composeMatrices pass
+    void update();
+
+private:
+    //  creates the entries up to id as identity
+    void grow(uint32_t id);
+
+    void markDirty(uint32_t id)
+    {
+        if (!dirty_[id])
+        {
+            dirty_[id] = 1;
+            dirtylist_.push_back(id);
+        }
+    }
+};
+
+}   //  end of VKTransformSystem namespace
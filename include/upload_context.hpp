@@ -0,0 +1,127 @@
+#pragma once
+
+#define GLFW_INCLUDE_VULKAN
+#include <GLFW/glfw3.h>
+
+#include "device.hpp"
+#include "swapchain.hpp"
+#include "buffmanager.hpp"
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace VKUpload
+{
+
+//  staging memory available to the uploads of one frame; the ring holds one such slice per frame in flight
+constexpr VkDeviceSize STAGING_FRAME_SIZE = 16ull * 1024 * 1024;
+constexpr VkDeviceSize  STAGING_RING_SIZE = STAGING_FRAME_SIZE * VKSwapchain::MAX_FRAMES_IN_FLIGHT;
+
+//  region of a staging buffer holding the source data of one copy
+struct Staging
+{
+    VkBuffer     buffer = VK_NULL_HANDLE;
+    VkDeviceSize offset =              0;
+};
+
+//  records copies and layout transitions of many resources into one command buffer and submits them
+//  to the transfer queue with a fence; staging buffers are kept alive until the fence of their batch signals.
+//  With a dedicated transfer family the resources are released by the transfer queue and acquired
+//  by the graphics queue once the copies are done, so uploads never stall the frames in flight
+class UploadContext final
+{
+    struct MipChain
+    {
+        VkImage      image = VK_NULL_HANDLE;
+        int32_t      width =              0;
+        int32_t     height =              0;
+        uint32_t miplevels =              1;
+    };
+
+    struct Batch
+    {
+        VkCommandBuffer                                          commandbuffer_ = VK_NULL_HANDLE;
+        VkFence                                                          fence_ = VK_NULL_HANDLE;
+
+        //  ownership acquire on the graphics queue, only used with a dedicated transfer family
+        VkCommandBuffer                                           acquirebuff_ = VK_NULL_HANDLE;
+        VkFence                                                   acquirefence_ = VK_NULL_HANDLE;
+        VkSemaphore                                                 semaphore_ = VK_NULL_HANDLE;
+        std::vector<VkBufferMemoryBarrier>                     bufferbarriers_;
+        std::vector<VkImageMemoryBarrier>                       imagebarriers_;
+        std::vector<MipChain>                                       mipchains_;    //  blits need the graphics queue
+        bool                                                         finished_ =          false;
+
+        uint64_t                                                        ticket_ =              0;
+        VkDeviceSize                                                 ringbytes_ =              0;
+        std::vector<std::unique_ptr<VKBuffmanager::Buffmanager>>       staging_;   //  uploads too big for the ring
+    };
+
+    VKDevice::Device&                 device_;
+    VkCommandPool                commandpool_ = VK_NULL_HANDLE;
+    VkCommandPool         acquirecommandpool_ = VK_NULL_HANDLE;
+    VkQueue                            queue_ = VK_NULL_HANDLE;
+    bool                          dedicated_ =          false;
+
+    Batch                          recording_;
+    bool                        hasrecording_ =          false;
+    bool                       hasbuffercopy_ =          false;
+    std::deque<Batch>               inflight_;
+    std::vector<Batch>                  free_;
+
+    uint64_t                      nextticket_ =              1;
+    uint64_t                     readyticket_ =              0;
+
+    //  persistently mapped staging ring, batches give their part of it back in submission order
+    std::unique_ptr<VKBuffmanager::Buffmanager> ring_;
+    VkDeviceSize                    ringhead_ =              0;
+    VkDeviceSize                    ringused_ =              0;
+    VkDeviceSize                   ringalign_ =             16;
+
+public:
+
+    UploadContext (VKDevice::Device& device);
+    ~UploadContext();
+
+    UploadContext(const UploadContext&) = delete;
+    UploadContext& operator=(const UploadContext&) = delete;
+
+    //  copies data into the staging ring, the space is reused once the current batch is finished;
+    //  when the ring is full the oldest batches are waited for
+    Staging stage(const void* data, VkDeviceSize size);
+
+    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset = 0, VkDeviceSize dstOffset = 0);
+    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset = 0, uint32_t mipLevel = 0);
+    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels = 1);
+
+    //  fills levels 1..mipLevels-1 from level 0 with linear blits; expects every level in TRANSFER_DST_OPTIMAL
+    //  and leaves all of them in SHADER_READ_ONLY_OPTIMAL. The format has to support linear filtering of blits
+    void generateMipmaps(VkImage image, int32_t width, int32_t height, uint32_t mipLevels);
+
+    //  submits everything recorded since the last submit without waiting and moves finished batches
+    //  over to the graphics queue. Returns the ticket of the batch (the last one if nothing was recorded)
+    uint64_t submit();
+
+    //  ticket the currently recorded commands will get on submit
+    uint64_t pendingTicket() const { return nextticket_; }
+
+    //  blocks until the batch is usable by the graphics queue
+    void wait(uint64_t ticket);
+    void flush() { wait(submit()); }
+
+    //  true when commands submitted to the graphics queue from now on see the uploaded data
+    bool isComplete(uint64_t ticket) const { return ticket <= readyticket_; }
+
+    //  hands finished transfers to the graphics queue and releases staging memory of them
+    void collect();
+
+private:
+    VkCommandBuffer begin();
+    void  acquireBatch(Batch& batch);
+    void  releaseBatch(Batch& batch);
+
+    bool reserveRing(VkDeviceSize size, VkDeviceSize& offset, VkDeviceSize& consumed);
+};
+
+}   //  end of VKUpload namespace
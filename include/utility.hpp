@@ -4,12 +4,16 @@
 #include <fstream>
 #include <vector>
 #include <functional>
+#include <cstdint>
 
 namespace Service
 {
 
     std::vector<char> readfile(const std::string &filename);
 
+    //  64-bit FNV-1a of the whole file content
+    uint64_t hashfile(const std::string &filename);
+
     //  simple hash function
     template <typename T, typename... Rest>
     void hashCombine(std::size_t& seed, const T&v, const Rest&... rest)
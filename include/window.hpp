@@ -20,7 +20,7 @@ class Window final
     using str_t      =    std::string;
     using window_ptr =    GLFWwindow*;
 
-    window_ptr                window_;
+    window_ptr      window_ = nullptr;  //  stays null in headless mode, nothing of GLFW is initialized then
     str_t                window_name_;
     size_t width_    =              0,
            height_   =              0;
@@ -31,13 +31,17 @@ class Window final
 
 public:
 
-    Window (const size_t& width, const size_t height, const str_t& name) :
+    Window (const size_t& width, const size_t height, const str_t& name, bool headless = false) :
                               width_{width}, height_{height}, window_name_{name}
     {
-        initWindow();
+        if (!headless)
+            initWindow();
     }
     ~Window()
     {
+        if (is_headless())
+            return;
+
         glfwDestroyWindow(window_);
         glfwTerminate();
     }
@@ -45,7 +49,8 @@ public:
     Window (const Window& window) = delete;
     Window &operator=(const Window &window) = delete;
 
-    bool shouldClose()           { return glfwWindowShouldClose(window_); }
+    bool is_headless()           const { return window_ == nullptr; }
+    bool shouldClose()           { return !is_headless() && glfwWindowShouldClose(window_); }
     bool wasresized()                       { return framebufferresized_; }
     void resetresized()                    { framebufferresized_ = false; }
 
@@ -0,0 +1,136 @@
+#include "alloc_counter.hpp"
+
+#include <new>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+#include <iomanip>
+
+namespace VKAllocCounter
+{
+    namespace
+    {
+        std::atomic<uint64_t>   totalallocations {0};
+        thread_local uint64_t  threadallocations  = 0;
+
+        //  names are string literals, so a phase is found by its pointer; registering takes a free slot without a lock
+        struct PhaseRecord
+        {
+            std::atomic<const char*>         name {nullptr};
+            std::atomic<uint64_t>     allocations {0};
+            std::atomic<uint64_t>            runs {0};
+        };
+        std::array<PhaseRecord, MAX_PHASES> phases;
+
+        PhaseRecord* findPhase(const char* name)
+        {
+            for (auto& phase : phases)
+            {
+                const char* current = phase.name.load(std::memory_order_acquire);
+                if (current == nullptr && phase.name.compare_exchange_strong(current, name, std::memory_order_acq_rel))
+                    return &phase;
+                if (current == name)
+                    return &phase;
+            }
+            return nullptr;
+        }
+    }
+
+    uint64_t       allocations() { return totalallocations.load(std::memory_order_relaxed); }
+    uint64_t threadAllocations() { return threadallocations; }
+
+    Phase::~Phase()
+    {
+        if (auto* phase = findPhase(name_))
+        {
+            phase->allocations.fetch_add(threadAllocations() - begin_, std::memory_order_relaxed);
+            phase->runs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void report(std::ostream& stream)
+    {
+        if (!ALLOC_COUNTING)
+            return;
+
+        stream << "allocations: " << allocations() << " in total" << std::endl;
+        for (const auto& phase : phases)
+        {
+            const char* name = phase.name.load(std::memory_order_acquire);
+            if (name == nullptr)
+                break;
+
+            auto runs        =        phase.runs.load(std::memory_order_relaxed);
+            auto allocations = phase.allocations.load(std::memory_order_relaxed);
+
+            stream << "  " << std::left << std::setw(20) << name << std::right << std::setw(10) << allocations
+                   << " in " << runs << " runs" << std::endl;
+        }
+    }
+
+}   //  end of VKAllocCounter namespace
+
+#if defined(VK_ALLOC_COUNTING)
+
+namespace
+{
+    void* countedAllocate(std::size_t size, std::size_t alignment = 0)
+    {
+        VKAllocCounter::totalallocations.fetch_add(1, std::memory_order_relaxed);
+        ++VKAllocCounter::threadallocations;
+
+        if (size == 0)
+            size = 1;
+
+        //  aligned_alloc wants the size to be a multiple of the alignment
+        void* memory = alignment > alignof(std::max_align_t) ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                                                             : std::malloc(size);
+        return memory;
+    }
+}
+
+void* operator new  (std::size_t size)
+{
+    if (void* memory = countedAllocate(size))
+        return memory;
+    throw std::bad_alloc{};
+}
+void* operator new[](std::size_t size)
+{
+    if (void* memory = countedAllocate(size))
+        return memory;
+    throw std::bad_alloc{};
+}
+void* operator new  (std::size_t size, std::align_val_t alignment)
+{
+    if (void* memory = countedAllocate(size, static_cast<std::size_t>(alignment)))
+        return memory;
+    throw std::bad_alloc{};
+}
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    if (void* memory = countedAllocate(size, static_cast<std::size_t>(alignment)))
+        return memory;
+    throw std::bad_alloc{};
+}
+
+void* operator new  (std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new  (std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return countedAllocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return countedAllocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete  (void* memory) noexcept                                    { std::free(memory); }
+void operator delete[](void* memory) noexcept                                    { std::free(memory); }
+void operator delete  (void* memory, std::size_t) noexcept                       { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept                       { std::free(memory); }
+void operator delete  (void* memory, std::align_val_t) noexcept                  { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept                  { std::free(memory); }
+void operator delete  (void* memory, std::size_t, std::align_val_t) noexcept     { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept     { std::free(memory); }
+void operator delete  (void* memory, const std::nothrow_t&) noexcept             { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept             { std::free(memory); }
+void operator delete  (void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+
+#endif
@@ -0,0 +1,306 @@
+#include "allocator.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+
+namespace VKAllocator
+{
+
+    namespace
+    {
+        VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    Allocator::Allocator(VkPhysicalDevice physdevice, VkDevice device, const VkPhysicalDeviceProperties& properties, VkDeviceSize blocksize) :
+                         device_{device}, blocksize_{blocksize}, noncoherentatomsize_{std::max<VkDeviceSize>(properties.limits.nonCoherentAtomSize, 1)}
+    {
+        vkGetPhysicalDeviceMemoryProperties(physdevice, &memoryprops_);
+    }
+
+    Allocator::~Allocator()
+    {
+        for (auto& block : blocks_)
+        {
+            if (block->mapped)
+                vkUnmapMemory(device_, block->memory);
+            vkFreeMemory(device_, block->memory, nullptr);
+        }
+    }
+
+    uint32_t Allocator::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+    {
+        for (uint32_t i = 0; i < memoryprops_.memoryTypeCount; i++)
+            if ((typeFilter & (1 << i)) && (memoryprops_.memoryTypes[i].propertyFlags & properties) == properties)
+                return i;
+
+        throw std::runtime_error("failed to find suitable memory type!");
+    }
+
+    VkDeviceSize Allocator::preferredBlockSize(uint32_t memorytype) const
+    {
+        //  small heaps (e.g. host visible device local windows) should not be eaten by a single block
+        VkDeviceSize heapsize = memoryprops_.memoryHeaps[memoryprops_.memoryTypes[memorytype].heapIndex].size;
+        return std::min(blocksize_, std::max<VkDeviceSize>(heapsize / 8, 1));
+    }
+
+    Block* Allocator::createBlock(VkDeviceSize size, uint32_t memorytype, bool linear, bool dedicated)
+    {
+        auto block = std::make_unique<Block>();
+        block->size       =       size;
+        block->memorytype = memorytype;
+        block->linear     =     linear;
+        block->dedicated  =  dedicated;
+
+        VkMemoryAllocateInfo allocInfo{};
+        allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+        allocInfo.allocationSize  =                                   size;
+        allocInfo.memoryTypeIndex =                             memorytype;
+
+        if (vkAllocateMemory(device_, &allocInfo, nullptr, &block->memory) != VK_SUCCESS)
+            return nullptr;
+
+        //  host visible blocks stay mapped for their whole life, so every allocation gets its pointer for free
+        if (memoryprops_.memoryTypes[memorytype].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            if (vkMapMemory(device_, block->memory, 0, VK_WHOLE_SIZE, 0, &block->mapped) != VK_SUCCESS)
+            {
+                vkFreeMemory(device_, block->memory, nullptr);
+                throw std::runtime_error("failed to map memory block!");
+            }
+        }
+
+        block->freeranges.emplace(0, size);
+
+        blocks_.push_back(std::move(block));
+        return blocks_.back().get();
+    }
+
+    void Allocator::destroyBlock(Block* block)
+    {
+        if (block->mapped)
+            vkUnmapMemory(device_, block->memory);
+        vkFreeMemory(device_, block->memory, nullptr);
+
+        auto it = std::find_if(blocks_.begin(), blocks_.end(), [block](const auto& owned) { return owned.get() == block; });
+        blocks_.erase(it);
+    }
+
+    bool Allocator::allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, Allocation& allocation)
+    {
+        //  first fit over the free list
+        for (auto range = block.freeranges.begin(); range != block.freeranges.end(); ++range)
+        {
+            VkDeviceSize rangeoffset = range->first;
+            VkDeviceSize rangesize   = range->second;
+            VkDeviceSize offset      = alignUp(rangeoffset, alignment);
+
+            if (offset + size > rangeoffset + rangesize)
+                continue;
+
+            block.freeranges.erase(range);
+            if (offset > rangeoffset)
+                block.freeranges.emplace(rangeoffset, offset - rangeoffset);
+            if (offset + size < rangeoffset + rangesize)
+                block.freeranges.emplace(offset + size, rangeoffset + rangesize - offset - size);
+
+            allocation.memory     =                                                           block.memory;
+            allocation.offset     =                                                                 offset;
+            allocation.size       =                                                                   size;
+            allocation.alignment  =                                                              alignment;
+            allocation.mapped     = block.mapped ? static_cast<char *>(block.mapped) + offset : nullptr;
+            allocation.memorytype =                                                       block.memorytype;
+            allocation.block      =                                                                 &block;
+
+            block.used += size;
+            block.allocations[offset] = allocation;
+
+            return true;
+        }
+
+        return false;
+    }
+
+    void Allocator::releaseRange(Block& block, VkDeviceSize offset, VkDeviceSize size)
+    {
+        block.used -= size;
+        block.allocations.erase(offset);
+
+        auto next = block.freeranges.lower_bound(offset);
+        if (next != block.freeranges.end() && offset + size == next->first)
+        {
+            size += next->second;
+            next  = block.freeranges.erase(next);
+        }
+
+        if (next != block.freeranges.begin())
+        {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset)
+            {
+                prev->second += size;
+                return;
+            }
+        }
+
+        block.freeranges.emplace(offset, size);
+    }
+
+    Allocation Allocator::allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear, void* userdata)
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        uint32_t memorytype = findMemoryType(requirements.memoryTypeBits, properties);
+
+        VkDeviceSize size      = requirements.size;
+        VkDeviceSize alignment = std::max<VkDeviceSize>(requirements.alignment, 1);
+
+        //  flushes and invalidations of non coherent memory work on whole atoms
+        auto flags = memoryprops_.memoryTypes[memorytype].propertyFlags;
+        if ((flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+        {
+            alignment = std::max(alignment, noncoherentatomsize_);
+            size      = alignUp(size, noncoherentatomsize_);
+        }
+
+        Allocation allocation{};
+        allocation.userdata = userdata;
+
+        VkDeviceSize preferred = preferredBlockSize(memorytype);
+
+        //  big resources would only fragment shared blocks
+        if (size <= preferred / 2)
+        {
+            for (auto& block : blocks_)
+                if (!block->dedicated && block->memorytype == memorytype && block->linear == linear &&
+                    block->size - block->used >= size && allocateFromBlock(*block, size, alignment, allocation))
+                    return allocation;
+
+            if (Block* block = createBlock(preferred, memorytype, linear, false))
+                if (allocateFromBlock(*block, size, alignment, allocation))
+                    return allocation;
+        }
+
+        Block* block = createBlock(size, memorytype, linear, true);
+        if (block == nullptr || !allocateFromBlock(*block, size, alignment, allocation))
+            throw std::runtime_error("failed to allocate device memory!");
+
+        return allocation;
+    }
+
+    void Allocator::free(Allocation& allocation)
+    {
+        if (allocation.block == nullptr)
+            return;
+
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        Block* block = allocation.block;
+        releaseRange(*block, allocation.offset, allocation.size);
+
+        //  one empty shared block per memory type is kept to avoid allocate/free ping-pong
+        if (block->used == 0)
+        {
+            bool spare = !block->dedicated && std::none_of(blocks_.begin(), blocks_.end(), [block](const auto& other)
+            {
+                return other.get() != block && !other->dedicated && other->used == 0 &&
+                       other->memorytype == block->memorytype && other->linear == block->linear;
+            });
+
+            if (!spare)
+                destroyBlock(block);
+        }
+
+        allocation = Allocation{};
+    }
+
+    VkDeviceSize Allocator::defragment(const MoveCallback& move, VkDeviceSize maxbytes)
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        std::vector<Block*> candidates;
+        for (auto& block : blocks_)
+            if (!block->dedicated)
+                candidates.push_back(block.get());
+
+        //  emptiest blocks are drained first into the fullest ones
+        std::sort(candidates.begin(), candidates.end(), [](const Block* lhs, const Block* rhs) { return lhs->used < rhs->used; });
+
+        VkDeviceSize moved = 0;
+        for (std::size_t src = 0; src < candidates.size() && moved < maxbytes; ++src)
+        {
+            Block* source = candidates[src];
+
+            std::vector<Allocation> movable;
+            for (auto& [offset, allocation] : source->allocations)
+                if (allocation.userdata != nullptr)
+                    movable.push_back(allocation);
+
+            for (auto& from : movable)
+            {
+                if (moved >= maxbytes)
+                    break;
+
+                for (std::size_t dst = candidates.size(); dst-- > src + 1;)
+                {
+                    Block* target = candidates[dst];
+                    if (target->memorytype != source->memorytype || target->linear != source->linear || target->size - target->used < from.size)
+                        continue;
+
+                    Allocation to{};
+                    to.userdata = from.userdata;
+                    if (!allocateFromBlock(*target, from.size, from.alignment, to))
+                        continue;
+
+                    if (move(from, to))
+                    {
+                        releaseRange(*source, from.offset, from.size);
+                        moved += from.size;
+                    }
+                    else
+                        releaseRange(*target, to.offset, to.size);
+
+                    break;
+                }
+            }
+        }
+
+        for (auto* block : candidates)
+            if (block->used == 0)
+                destroyBlock(block);
+
+        return moved;
+    }
+
+    Statistics Allocator::getStatistics() const
+    {
+        std::lock_guard<std::mutex> lock {mutex_};
+
+        Statistics statistics{};
+        for (auto& block : blocks_)
+        {
+            statistics.blockcount++;
+            statistics.dedicatedcount  += block->dedicated ? 1 : 0;
+            statistics.allocationcount +=  block->allocations.size();
+            statistics.freerangecount  +=   block->freeranges.size();
+            statistics.reservedbytes   +=                block->size;
+            statistics.usedbytes       +=                block->used;
+
+            for (auto& [offset, size] : block->freeranges)
+                statistics.largestfreerange = std::max(statistics.largestfreerange, size);
+        }
+
+        return statistics;
+    }
+
+    std::ostream& operator<< (std::ostream& os, const Statistics& statistics)
+    {
+        return os << "blocks: "      << statistics.blockcount << " (" << statistics.dedicatedcount << " dedicated)"
+                  << ", allocations: " << statistics.allocationcount
+                  << ", used: "      << statistics.usedbytes << " of " << statistics.reservedbytes << " bytes"
+                  << ", free ranges: " << statistics.freerangecount << " (largest " << statistics.largestfreerange << " bytes)";
+    }
+
+}   //  end of VKAllocator namespace
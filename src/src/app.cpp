@@ -1,6 +1,10 @@
 #include "app.hpp"
 
 #include "render_system.hpp"
+#include "upload_context.hpp"
+#include "bindless.hpp"
+#include "cpu_profiler.hpp"
+#include "alloc_counter.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -8,115 +12,258 @@
 #include <glm/gtc/constants.hpp>
 
 #include <array>
+#include <numeric>
 #include <cassert>
+#include <algorithm>
+#include <string>
 #include <stdexcept>
 
 namespace VKEngine
 {
 
-    void App::run()
+    namespace
     {
-        //  creating uniform buffers for global data
-        std::vector<std::unique_ptr<VKBuffmanager::Buffmanager>> ubobuffs (VKSwapchain::MAX_FRAMES_IN_FLIGHT);
-        for (int i = 0; i < ubobuffs.size(); ++i)
+        void reportFrameTimes(std::vector<float> frametimes)
         {
-            ubobuffs[i] = std::make_unique<VKBuffmanager::Buffmanager> (device_, sizeof(GlobalUbo), VKSwapchain::MAX_FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                                                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, (uint16_t) device_.get_properties().limits.minUniformBufferOffsetAlignment);
-            ubobuffs[i]->map();
+            if (frametimes.empty())
+                return;
+
+            std::sort(frametimes.begin(), frametimes.end());
+
+            float total = std::accumulate(frametimes.begin(), frametimes.end(), 0.f);
+            auto  ms    = [](float seconds) { return seconds * 1000.f; };
+
+            std::cout << "frames: " << frametimes.size()
+                      << ", mean: " << ms(total / frametimes.size())                        << " ms"
+                      << ", p50: "  << ms(frametimes[frametimes.size() / 2])                << " ms"
+                      << ", p99: "  << ms(frametimes[(frametimes.size() - 1) * 99 / 100])   << " ms"
+                      << ", max: "  << ms(frametimes.back())                                << " ms" << std::endl;
         }
+    }
 
+    void App::run()
+    {
+        VK_CPU_THREAD("main");
 
-        //  creating layout for GLOBAL set and it respectively
-        auto setlayout = VKDescriptors::DescriptorSetLayout::Builder(device_).addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT, 1)
-                                                                             .addBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, 1).build();
-        std::vector<VkDescriptorSet> descriptorsets(VKSwapchain::MAX_FRAMES_IN_FLIGHT * objects_.size()); 
-        int descriptorSetIndex = 0;
-        for (int frame = 0; frame < VKSwapchain::MAX_FRAMES_IN_FLIGHT; frame++) 
-        {
-            auto bufferInfo = ubobuffs[frame]->descriptorInfo();
+        //  one persistently mapped ring of global uniforms, a slot per frame in flight; slots are also flushed one by one,
+        //  so they are aligned for both dynamic offsets and non-coherent flushes
+        auto  limits       = device_.get_properties().limits;
+        auto  uboalignment = std::max(limits.minUniformBufferOffsetAlignment, limits.nonCoherentAtomSize);
 
-            for (auto& obj : objects_)
-            {
-                VkDescriptorImageInfo imageInfo{};
-                imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-                imageInfo.imageView = obj.model_->getimgview();
-                imageInfo.sampler = obj.model_->getsampler();
+        VKBuffmanager::Buffmanager ubobuff {device_, sizeof(GlobalUbo), VKSwapchain::MAX_FRAMES_IN_FLIGHT, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                                            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, uboalignment};
+        ubobuff.map();
 
-                VKDescriptors::DescriptorWriter(*setlayout, *globalPool).writeBuffer(0, &bufferInfo).writeImage(1, &imageInfo).build(descriptorsets[descriptorSetIndex]);
 
-                descriptorSetIndex++;  // Increment the index explicitly
-            }
+        //  creating layout for GLOBAL set and it respectively; textures are not part of it, they live in the bindless set of the device.
+        //  A single set covers every frame, the slot is picked by the dynamic offset at bind time
+        auto setlayout = VKDescriptors::DescriptorSetLayout::Builder(device_).addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT, 1).build();
+        VkDescriptorSet globalset;
+        {
+            auto bufferInfo = ubobuff.descriptorInfoForIndex(0);
+            VKDescriptors::DescriptorWriter(*setlayout, *globalPool).writeBuffer(0, &bufferInfo).build(globalset);
         }
 
-        auto descriptorSetLayouts = std::vector<VkDescriptorSetLayout> {setlayout->getDescriptorSetLayout()};
+        auto descriptorSetLayouts = std::vector<VkDescriptorSetLayout> {setlayout->getDescriptorSetLayout(), device_.get_textures().get_layout()};
         VKRenderSystem::RenderSystem renderSystem {device_, renderer_.getSwapChainRenderPass(), descriptorSetLayouts};
 
 
         VKCamera::Camera camera{};
 
-        auto viewerObject =    VKObject::Object::createObject();
+        VKObject::Transform3Dcomponent viewer{};
         VKKeyboardController::KeyboardController cameraController{};
 
+        std::vector<float> frametimes;
+        if (settings_.headless)
+        {
+            //  fixed view of the whole grid, every model and texture resident before the first measured frame
+            viewer.translation = {9.f, 9.f, -25.f};
+            textures_.flush();
+            device_.get_uploader().flush();
+            frametimes.reserve(settings_.frames);
+        }
+
         auto currentTime = std::chrono::high_resolution_clock::now();
+        bool presentkeydown = false;
+        bool profilekeydown = false;
+
+        auto& profiler = renderer_.getProfiler();
+
+        uint64_t steadyallocations = 0;   //  heap allocations of all threads during frames after the warmup
 
-        while(!window_.shouldClose())
+        while(!window_.shouldClose() && (!settings_.headless || frametimes.size() < settings_.frames))
         {
-            glfwPollEvents();
+            VK_CPU_ZONE("frame");
+            auto frameallocations = VKAllocCounter::allocations();
+
+            if (!settings_.headless)
+            {
+                VK_CPU_ZONE("poll events");
+                glfwPollEvents();
+            }
 
             auto newTime = std::chrono::high_resolution_clock::now();
             float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
             currentTime = newTime;
 
-            cameraController.moveInPlaneXZ(window_.get(), frameTime, viewerObject);
-            camera.setViewYXZ(viewerObject.transform3D_.translation, viewerObject.transform3D_.rotation);
+            {
+                VK_CPU_ZONE("camera");
+                if (!settings_.headless)
+                {
+                    cameraController.moveInPlaneXZ(window_.get(), frameTime, viewer);
+
+                    //  V cycles through the present modes, the swapchain is recreated without a restart
+                    bool keydown = glfwGetKey(window_.get(), GLFW_KEY_V) == GLFW_PRESS;
+                    if (keydown && !presentkeydown)
+                    {
+                        auto policy = renderer_.getPresentPolicy();
+                        policy.mode = static_cast<VKSwapchain::PresentMode>((static_cast<int>(policy.mode) + 1) % VKSwapchain::PRESENT_MODE_COUNT);
+                        renderer_.setPresentPolicy(policy);
+                    }
+                    presentkeydown = keydown;
+
+                    //  P writes the GPU scope averages of the last frames on demand
+                    keydown = glfwGetKey(window_.get(), GLFW_KEY_P) == GLFW_PRESS;
+                    if (keydown && !profilekeydown && !settings_.profilepath.empty())
+                        profiler.dump(settings_.profilepath);
+                    profilekeydown = keydown;
+                }
+                camera.setViewYXZ(viewer.translation, viewer.rotation);
+
+                float aspect = renderer_.getAspectRatio();
+                camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 1000.f);
+            }
+
+            //  decoded textures are recorded into the upload batch beginFrame submits
+            {
+                VK_CPU_ZONE("textures");
+                textures_.update();
+            }
 
-            float aspect = renderer_.getAspectRatio();
-            camera.setPerspectiveProjection(glm::radians(50.f), aspect, 0.1f, 1000.f);
+            VkCommandBuffer commandBuffer;
+            {
+                VK_CPU_ZONE("begin frame");
+                commandBuffer = renderer_.beginFrame();
+            }
 
-            if (auto commandBuffer = renderer_.beginFrame())
+            if (commandBuffer)
             {
                 int frameindex = renderer_.getframeindex();
 
-                std::vector<VkDescriptorSet> Descriptorsets {};
-                for (int i = 0, len = objects_.size(); i < objects_.size(); i++)
-                    descriptorsets.push_back(descriptorsets[len * frameindex + i]);
-                
+                auto& arena = renderer_.getFrameArena();
+
+                //  global uniforms of this frame and the bindless textures
+                auto sets = arena.allocate<VkDescriptorSet>(2);
+                sets[0]   =                         globalset;
+                sets[1]   = device_.get_textures().get_set();
 
-                VKRenderSystem::FrameInfo frameinfo {frameindex, frameTime, commandBuffer, camera, descriptorsets};
+                auto offsets = arena.allocate<uint32_t>(1);
+                offsets[0]   = static_cast<uint32_t>(frameindex * ubobuff.getAlignmentSize());
+
+                VKRenderSystem::FrameInfo frameinfo {frameindex, frameTime, commandBuffer, camera, arena, sets, offsets};
 
                 //  update Ubo
-                GlobalUbo ubo{};
-                ubo.projectionView = camera.getProjection() * camera.getView();
+                {
+                    VK_CPU_ZONE("ubo");
+
+                    GlobalUbo ubo{};
+                    ubo.projectionView = camera.getProjection() * camera.getView();
 
-                ubobuffs[frameindex]->writeToBuffer(&ubo);
-                ubobuffs[frameindex]->flush();
+                    ubobuff.writeToIndex(&ubo, frameindex);
+                    ubobuff.flushIndex(frameindex);
+                }
 
                 //  renderer
-                renderer_.beginSwapchainRenderpass(commandBuffer);
-                renderSystem.renderObjects(frameinfo, objects_);
-                renderer_.endSwapchainRenderpass(commandBuffer);
-                renderer_.endFrame();
+                {
+                    VK_CPU_ZONE("record");
+
+                    //  only objects moved since the last frame get their matrices rebuilt
+                    transforms_.update();
+
+                    auto cullscope = profiler.beginScope(commandBuffer, "cull", true);
+                    renderSystem.cullObjects(frameinfo, objects_, transforms_);
+                    profiler.endScope(commandBuffer, cullscope);
+
+                    //  many distinct models are recorded on all threads, the calling one included
+                    if (auto recorders = renderSystem.recorderCount(frameinfo, threadpool_.size() + 1); recorders > 1)
+                    {
+                        renderer_.beginSwapchainRenderpass(commandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+                        renderSystem.renderObjects(frameinfo, renderer_.beginSecondaryCommandBuffers(recorders), threadpool_);
+                        renderer_.executeSecondaryCommandBuffers(commandBuffer);
+                    }
+                    else
+                    {
+                        renderer_.beginSwapchainRenderpass(commandBuffer);
+
+                        //  timestamps can not be written between secondaries, so only the inline path is measured apart from its pass
+                        auto objectsscope = profiler.beginScope(commandBuffer, "objects");
+                        renderSystem.renderObjects(frameinfo);
+                        profiler.endScope(commandBuffer, objectsscope);
+                    }
+                    renderer_.endSwapchainRenderpass(commandBuffer);
+                }
+
+                {
+                    VK_CPU_ZONE("end frame");
+                    renderer_.endFrame();
+                }
+
+                if (settings_.headless)
+                    frametimes.push_back(frameTime);
             }
 
+            if (frametimes.size() > ALLOC_WARMUP_FRAMES)
+                steadyallocations += VKAllocCounter::allocations() - frameallocations;
+
         }
 
         vkDeviceWaitIdle(device_.get_logic());
+
+        if (!settings_.profilepath.empty())
+            profiler.dump(settings_.profilepath);
+
+        if (!settings_.tracepath.empty())
+            VKProfiler::dumpChromeTrace(settings_.tracepath);
+
+        if (settings_.headless)
+        {
+            //  the first frame also measured the setup above
+            if (!frametimes.empty())
+                frametimes.erase(frametimes.begin());
+            reportFrameTimes(frametimes);
+
+            if (VKAllocCounter::ALLOC_COUNTING)
+            {
+                VKAllocCounter::report(std::cout);
+                std::cout << "steady-state allocations: " << steadyallocations << std::endl;
+
+                if (settings_.allocfree && steadyallocations != 0)
+                    throw std::runtime_error("failed to keep frames allocation free: " + std::to_string(steadyallocations) +
+                                             " allocations after the warmup!");
+            }
+
+            if (!settings_.capturepath.empty())
+                renderer_.captureFrame(settings_.capturepath);
+        }
     }
 
     void App::loadObjects()
     {
 
+        std::vector<VKAssetRegistry::AssetRegistry::Request> requests (100, {"../../src/src/assets/viking_room.obj",
+                                                                             "../../src/src/assets/viking_room.png"});
+        auto models = assets_.loadModels(requests, threadpool_);
+
         for (int i = 0; i < 10; i++)
         {
             for (int j = 0; j < 10; j++)
             {
-                std::shared_ptr<VKModel::Model> model_viking_room =  VKModel::Model::createModelfromFile (device_,  "../../src/src/assets/viking_room.obj",
-                                                                                                            "../../src/src/assets/viking_room.png");
-                auto obj_viking_room                     =   VKObject::Object::createObject();
-                obj_viking_room.model_                   =                  model_viking_room;
-                obj_viking_room.transform3D_.translation =         {i * 2.0f, j * 2.0f, 0.0f};
-                obj_viking_room.transform3D_.scale       =                    glm::vec3{0.8f};
-                obj_viking_room.transform3D_.rotation    =               {1.57f, 1.57f, 0.0f};
+                auto obj_viking_room   =   VKObject::Object::createObject();
+                obj_viking_room.model_ =                models[i * 10 + j];
+
+                transforms_.set(obj_viking_room.get_id(), {.translation = {i * 2.0f, j * 2.0f, 0.0f},
+                                                           .scale       =            glm::vec3{0.8f},
+                                                           .rotation    =       {1.57f, 1.57f, 0.0f}});
 
                 objects_.push_back(std::move(obj_viking_room));
             }
@@ -128,8 +275,7 @@ namespace VKEngine
         //                                                                                                     "../../src/src/assets/shrek.png");
         // auto obj_shrek1                     = VKObject::Object::createObject();
         // obj_shrek1.model_                   =                     model_shrek1;
-        // obj_shrek1.transform3D_.translation =              {0.0f, -1.0f, 0.0f};
-        // obj_shrek1.transform3D_.scale       =                glm::vec3{ -0.8f};
+        // transforms_.set(obj_shrek1.get_id(), {.translation = {0.0f, -1.0f, 0.0f}, .scale = glm::vec3{ -0.8f}});
 
         // objects_.push_back(std::move(obj_shrek1));
 
@@ -139,8 +285,7 @@ namespace VKEngine
         //                                                                                                     "../../src/src/assets/shrek.png");
         // auto obj_shrek2                     = VKObject::Object::createObject();
         // obj_shrek2.model_                   =                     model_shrek2;
-        // obj_shrek2.transform3D_.translation =              {0.0f, 1.0f, 0.0f};
-        // obj_shrek2.transform3D_.scale       =                glm::vec3{ 0.8f};
+        // transforms_.set(obj_shrek2.get_id(), {.translation = {0.0f, 1.0f, 0.0f}, .scale = glm::vec3{ 0.8f}});
 
         // objects_.push_back(std::move(obj_shrek2));
 
@@ -150,8 +295,7 @@ namespace VKEngine
         //                                                                                                     "../../src/src/assets/shrek.png");
         // auto obj_shrek3                     = VKObject::Object::createObject();
         // obj_shrek3.model_                   =                     model_shrek3;
-        // obj_shrek3.transform3D_.translation =               {2.0f, 1.0f, 0.0f};
-        // obj_shrek3.transform3D_.scale       =                 glm::vec3{ -0.8f};
+        // transforms_.set(obj_shrek3.get_id(), {.translation = {2.0f, 1.0f, 0.0f}, .scale = glm::vec3{ -0.8f}});
 
         // objects_.push_back(std::move(obj_shrek3));
 
@@ -161,11 +305,12 @@ namespace VKEngine
         //                                                                                                     "../../src/src/assets/shrek.png");
         // auto obj_shrek4                     = VKObject::Object::createObject();
         // obj_shrek4.model_                   =                     model_shrek4;
-        // obj_shrek4.transform3D_.translation =               {-2.0f, -1.0f, 0.0f};
-        // obj_shrek4.transform3D_.scale       =                 glm::vec3{ 0.8f};
+        // transforms_.set(obj_shrek4.get_id(), {.translation = {-2.0f, -1.0f, 0.0f}, .scale = glm::vec3{ 0.8f}});
 
         // objects_.push_back(std::move(obj_shrek4));
 
+        //  the whole scene goes to the GPU with a single submit
+        device_.get_uploader().submit();
     }
 
 }   //  end of VKEngine namespace
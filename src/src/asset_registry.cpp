@@ -0,0 +1,210 @@
+#include "asset_registry.hpp"
+
+#include "utility.hpp"
+#include "upload_context.hpp"
+
+#include <vector>
+#include <filesystem>
+
+namespace VKAssetRegistry
+{
+
+    AssetRegistry::AssetRegistry (VKDevice::Device& device, VKTextureLoader::TextureLoader* textures, VkDeviceSize budget) :
+                                  device_{device}, textures_{textures}, budget_{budget}
+    {
+        if (textures_)
+            textures_->setPublishCallback([this](const VKModel::Model& model) { onTexturePublished(model); });
+    }
+
+    AssetRegistry::~AssetRegistry()
+    {
+        //  the loader may outlive the registry
+        if (textures_)
+            textures_->setPublishCallback(nullptr);
+    }
+
+    std::size_t AssetRegistry::KeyHash::operator() (const Key& key) const
+    {
+        std::size_t seed = 0;
+        Service::hashCombine(seed, key.filepath_to_model, key.filepath_to_texture, key.contenthash);
+        return seed;
+    }
+
+    uint64_t AssetRegistry::hashFile(const std::string& filepath)
+    {
+        if (filepath.empty())
+            return 0;
+
+        std::filesystem::path path {filepath};
+        uint64_t filesize  = std::filesystem::file_size(path);
+        int64_t  writetime = std::filesystem::last_write_time(path).time_since_epoch().count();
+
+        auto stamp = filestamps_.find(filepath);
+        if (stamp != filestamps_.end() && stamp->second.filesize == filesize && stamp->second.writetime == writetime)
+            return stamp->second.contenthash;
+
+        uint64_t contenthash   = Service::hashfile(filepath);
+        filestamps_[filepath]  = FileStamp{filesize, writetime, contenthash};
+
+        return contenthash;
+    }
+
+    AssetRegistry::Key AssetRegistry::makeKey (const std::string& filepath_to_model, const std::string& filepath_to_texture)
+    {
+        uint64_t contenthash = hashFile(filepath_to_model) ^ (hashFile(filepath_to_texture) * 0x9e3779b97f4a7c15ull);
+
+        return Key{filepath_to_model, filepath_to_texture, contenthash};
+    }
+
+    std::shared_ptr<VKModel::Model> AssetRegistry::find (const Key& key)
+    {
+        auto found = entries_.find(key);
+        if (found == entries_.end())
+            return nullptr;
+
+        lru_.splice(lru_.begin(), lru_, found->second.lruit_);     //  mark as the most recently used
+        ++hits_;
+
+        return found->second.model_;
+    }
+
+    void AssetRegistry::insert (Key key, const std::shared_ptr<VKModel::Model>& model)
+    {
+        ++misses_;
+
+        lru_.push_front(key);
+        Entry entry {model, model->getMemorySize(), lru_.begin()};
+
+        residentsize_ += entry.size_;
+        auto inserted  = entries_.emplace(std::move(key), std::move(entry)).first;
+
+        entryofmodel_[model.get()] = &inserted->second;
+    }
+
+    void AssetRegistry::onTexturePublished (const VKModel::Model& model)
+    {
+        auto found = entryofmodel_.find(&model);
+        if (found == entryofmodel_.end())
+            return;
+
+        Entry& entry   = *found->second;
+        residentsize_ -= entry.size_;
+        entry.size_    = model.getMemorySize();
+        residentsize_ += entry.size_;
+
+        trim();
+    }
+
+    std::shared_ptr<VKModel::Model> AssetRegistry::loadModel (const std::string& filepath_to_model, const std::string& filepath_to_texture)
+    {
+        Key key = makeKey(filepath_to_model, filepath_to_texture);
+
+        if (auto model = find(key))
+            return model;
+
+        std::shared_ptr<VKModel::Model> model = VKModel::Model::createModelfromFile(device_, filepath_to_model, filepath_to_texture);
+        insert(std::move(key), model);
+
+        trim();
+
+        return model;
+    }
+
+    std::vector<std::shared_ptr<VKModel::Model>> AssetRegistry::loadModels (const std::vector<Request>& requests, VKThreadPool::ThreadPool& pool)
+    {
+        std::vector<Key>                             keys;
+        std::vector<VKModel::Model::Builder>     builders;
+        std::vector<const std::string *>       modelpaths;
+        std::vector<const std::string *>     texturepaths;
+        std::unordered_map<Key, std::size_t, KeyHash>  pending;    //  key -> index of its builder
+
+        keys.reserve(requests.size());
+        for (const auto& request : requests)
+        {
+            keys.push_back(makeKey(request.filepath_to_model, request.filepath_to_texture));
+
+            if (entries_.count(keys.back()) || !pending.emplace(keys.back(), builders.size()).second)
+                continue;
+
+            builders.emplace_back();
+            builders.back().filepath_to_texture = textures_ ? std::string{} : request.filepath_to_texture;
+            modelpaths.push_back(&request.filepath_to_model);
+            texturepaths.push_back(&request.filepath_to_texture);
+        }
+
+        //  parsing and deduplication are pure CPU work, every mesh gets its own task
+        pool.parallel_for(builders.size(), [&](std::size_t index) { builders[index].load_models(*modelpaths[index], &pool); });
+
+        //  uploads go through the single upload context, so models are created on this thread
+        std::vector<std::shared_ptr<VKModel::Model>> models;
+        models.reserve(requests.size());
+
+        for (auto& key : keys)
+        {
+            auto model = find(key);
+            if (!model)
+            {
+                auto builder = pending.at(key);
+
+                model = std::make_shared<VKModel::Model>(device_, builders[builder]);
+                insert(key, model);
+
+                if (textures_ && !texturepaths[builder]->empty())
+                    textures_->request(model, *texturepaths[builder]);
+            }
+
+            models.push_back(std::move(model));
+        }
+
+        trim();
+
+        return models;
+    }
+
+    void AssetRegistry::trim()
+    {
+        if (residentsize_ <= budget_)
+            return;
+
+        std::vector<std::shared_ptr<VKModel::Model>> evicted;
+
+        //  walking from the least recently used; models still owned by objects are skipped
+        for (auto it = lru_.end(); it != lru_.begin() && residentsize_ > budget_;)
+        {
+            --it;
+
+            auto entry = entries_.find(*it);
+            if (entry->second.model_.use_count() > 1)
+                continue;
+
+            residentsize_ -= entry->second.size_;
+            entryofmodel_.erase(entry->second.model_.get());
+            evicted.push_back(std::move(entry->second.model_));
+
+            entries_.erase(entry);
+            it = lru_.erase(it);
+        }
+
+        //  evicted model could be referenced by command buffers which are still in flight
+        if (!evicted.empty())
+        {
+            device_.get_uploader().flush();
+            vkDeviceWaitIdle(device_.get_logic());
+        }
+    }
+
+    void AssetRegistry::clear()
+    {
+        if (!entries_.empty())
+        {
+            device_.get_uploader().flush();
+            vkDeviceWaitIdle(device_.get_logic());
+        }
+
+        entries_.clear();
+        entryofmodel_.clear();
+        lru_.clear();
+        residentsize_ = 0;
+    }
+
+}   //  end of VKAssetRegistry namespace
@@ -0,0 +1,145 @@
+#include "bindless.hpp"
+
+#include "upload_context.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <stdexcept>
+
+namespace VKBindless
+{
+
+    namespace
+    {
+        //  the fragment stage also sees the global uniforms and the colour attachment, they count as resources too
+        constexpr uint32_t RESERVED_STAGE_RESOURCES = 4;
+    }
+
+    //  every element is a sampler and a sampled image at once, so the array is held to both kinds of limits
+    uint32_t TextureArray::deviceCapacity(VkPhysicalDevice device)
+    {
+        VkPhysicalDeviceDescriptorIndexingProperties indexingProperties{};
+        indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext =                             &indexingProperties;
+
+        vkGetPhysicalDeviceProperties2(device, &properties);
+
+        uint32_t resources = indexingProperties.maxPerStageUpdateAfterBindResources;
+        resources          = resources > RESERVED_STAGE_RESOURCES ? resources - RESERVED_STAGE_RESOURCES : 0;
+
+        return std::min({MAX_BINDLESS_TEXTURES, resources,
+                         indexingProperties.maxPerStageDescriptorUpdateAfterBindSamplers,
+                         indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                         indexingProperties.maxDescriptorSetUpdateAfterBindSamplers,
+                         indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages});
+    }
+
+    TextureArray::TextureArray(VKDevice::Device& device) : device_{device}, capacity_{deviceCapacity(device.get_phys())}
+    {
+        assert(capacity_ > FALLBACK_TEXTURE + 1 && "isDeviceSuitable rejects devices without room for textures besides the fallback");
+
+        layout_ = VKDescriptors::DescriptorSetLayout::Builder(device_)
+                  .addBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT, capacity_,
+                              VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT)
+                  .setLayoutFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT)
+                  .build();
+
+        pool_ = VKDescriptors::DescriptorPool::Builder(device_).setMaxSets (1)
+                                                               .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, capacity_)
+                                                               .setPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+                                                               .build();
+
+        if (!pool_->allocateDescriptor(layout_->getDescriptorSetLayout(), set_))
+            throw std::runtime_error("failed to allocate bindless texture set!");
+
+        createFallbackTexture();
+        write(FALLBACK_TEXTURE, fallbackimgview_, fallbacksampler_);
+    }
+
+    TextureArray::~TextureArray()
+    {
+        pool_.reset();
+        layout_.reset();
+
+        vkDestroySampler  (device_.get_logic(), fallbacksampler_, nullptr);
+        vkDestroyImageView(device_.get_logic(), fallbackimgview_, nullptr);
+        device_.destroyImage(fallbackimg_, fallbackimgmem_);
+    }
+
+    uint32_t TextureArray::add(VkImageView view, VkSampler sampler)
+    {
+        uint32_t index;
+        if (!freeslots_.empty())
+        {
+            index = freeslots_.back();
+            freeslots_.pop_back();
+        }
+        else if (nextslot_ < capacity_)
+            index = nextslot_++;
+        else
+            throw std::runtime_error("failed to add texture: bindless texture array is full!");
+
+        write(index, view, sampler);
+        return index;
+    }
+
+    void TextureArray::remove(uint32_t index)
+    {
+        if (index == FALLBACK_TEXTURE || index >= nextslot_)
+            return;
+
+        write(index, fallbackimgview_, fallbacksampler_);
+        freeslots_.push_back(index);
+    }
+
+    void TextureArray::write(uint32_t index, VkImageView view, VkSampler sampler)
+    {
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView   =                                     view;
+        imageInfo.sampler     =                                  sampler;
+
+        VKDescriptors::DescriptorWriter(*layout_, *pool_).writeImageAt(0, index, &imageInfo).overwrite(set_);
+    }
+
+    void TextureArray::createFallbackTexture()
+    {
+        const uint32_t white = 0xffffffff;
+
+        device_.createImage(1, 1, 1, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+                            VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                            fallbackimg_, fallbackimgmem_);
+
+        auto& uploader = device_.get_uploader();
+        uploader.transitionImageLayout(fallbackimg_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+        VKUpload::Staging staging = uploader.stage(&white, sizeof(white));
+        uploader.copyBufferToImage(staging.buffer, fallbackimg_, 1, 1, staging.offset);
+
+        uploader.transitionImageLayout(fallbackimg_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+        fallbackimgview_ = device_.createImageView(fallbackimg_, VK_FORMAT_R8G8B8A8_SRGB);
+
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType                   = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter               =                     VK_FILTER_NEAREST;
+        samplerInfo.minFilter               =                     VK_FILTER_NEAREST;
+        samplerInfo.addressModeU            =        VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeV            =        VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.addressModeW            =        VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        samplerInfo.anisotropyEnable        =                              VK_FALSE;
+        samplerInfo.maxAnisotropy           =                                  1.0f;
+        samplerInfo.borderColor             =      VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+        samplerInfo.unnormalizedCoordinates =                              VK_FALSE;
+        samplerInfo.compareEnable           =                              VK_FALSE;
+        samplerInfo.compareOp               =                  VK_COMPARE_OP_ALWAYS;
+        samplerInfo.mipmapMode              =        VK_SAMPLER_MIPMAP_MODE_NEAREST;
+
+        if (vkCreateSampler(device_.get_logic(), &samplerInfo, nullptr, &fallbacksampler_) != VK_SUCCESS)
+            throw std::runtime_error("failed to create fallback texture sampler!");
+    }
+
+}   //  end of VKBindless namespace
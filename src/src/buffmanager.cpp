@@ -19,29 +19,31 @@ namespace VKBuffmanager
     {
         alignmentsize_ = getAlignment(instanceSize, minOffsetAlignment);
         buffersize_ = alignmentsize_ * instanceCount;
-        device_.createBuffer(buffersize_, usageFlags, memoryPropertyFlags, buffer_, memory_);
+        device_.createBuffer(buffersize_, usageFlags, memoryPropertyFlags, buffer_, allocation_);
     }
  
     Buffmanager::~Buffmanager() 
     {
         unmap();
-        vkDestroyBuffer(device_.get_logic(), buffer_, nullptr);
-        vkFreeMemory   (device_.get_logic(), memory_, nullptr);
+        device_.destroyBuffer(buffer_, allocation_);
     }
 
-    VkResult Buffmanager::map(VkDeviceSize size, VkDeviceSize offset) 
+    VkResult Buffmanager::map([[maybe_unused]] VkDeviceSize size, VkDeviceSize offset) 
     {
-        assert(buffer_ && memory_ && "Called map on buffer before create");
-        return vkMapMemory(device_.get_logic(), memory_, offset, size, 0, &mapped_);
+        assert(buffer_ && allocation_.memory && "Called map on buffer before create");
+        assert((size == VK_WHOLE_SIZE ? offset <= buffersize_ : offset + size <= buffersize_) && "Mapped range is out of buffer");
+
+        //  host visible blocks are persistently mapped by the allocator, so mapping is just pointer arithmetic
+        if (allocation_.mapped == nullptr)
+            return VK_ERROR_MEMORY_MAP_FAILED;
+
+        mapped_ = static_cast<char *>(allocation_.mapped) + offset;
+        return VK_SUCCESS;
     }
  
     void Buffmanager::unmap() 
     {
-        if (mapped_) 
-        {
-            vkUnmapMemory(device_.get_logic(), memory_);
-            mapped_ = nullptr;
-        }
+        mapped_ = nullptr;
     }
  
     void Buffmanager::writeToBuffer(void *data, VkDeviceSize size, VkDeviceSize offset) 
@@ -62,9 +64,9 @@ namespace VKBuffmanager
     {
         VkMappedMemoryRange mappedRange {};
         mappedRange.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory =                               memory_;
-        mappedRange.offset =                                offset;
-        mappedRange.size   =                                  size;
+        mappedRange.memory =                    allocation_.memory;
+        mappedRange.offset =             allocation_.offset + offset;
+        mappedRange.size   = size == VK_WHOLE_SIZE ? allocation_.size - offset : size;
         return vkFlushMappedMemoryRanges(device_.get_logic(), 1, &mappedRange);
     }
 
@@ -72,9 +74,9 @@ namespace VKBuffmanager
     {
         VkMappedMemoryRange mappedRange {};
         mappedRange.sType  = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
-        mappedRange.memory =                               memory_;
-        mappedRange.offset =                                offset;
-        mappedRange.size   =                                  size;
+        mappedRange.memory =                    allocation_.memory;
+        mappedRange.offset =             allocation_.offset + offset;
+        mappedRange.size   = size == VK_WHOLE_SIZE ? allocation_.size - offset : size;
         return vkInvalidateMappedMemoryRanges(device_.get_logic(), 1, &mappedRange);
     }
  
@@ -87,7 +89,7 @@ namespace VKBuffmanager
 
     void Buffmanager::writeToIndex(void *data, int index)  { writeToBuffer(data, instancesize_, index * alignmentsize_); }
     VkResult Buffmanager::flushIndex(int index)            {       return flush(alignmentsize_, index * alignmentsize_); }
-    VkDescriptorBufferInfo Buffmanager::descriptorInfoForIndex(int index) { return descriptorInfo(alignmentsize_, index * alignmentsize_); }
+    VkDescriptorBufferInfo Buffmanager::descriptorInfoForIndex(int index) { return descriptorInfo(instancesize_,  index * alignmentsize_); }
     VkResult Buffmanager::invalidateIndex(int index)                      {     return invalidate(alignmentsize_, index * alignmentsize_); }
     
 }   //  end of namespace VKBuffmanager
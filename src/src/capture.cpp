@@ -0,0 +1,126 @@
+#include "swapchain.hpp"
+
+#include "buffmanager.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+namespace VKSwapchain
+{
+
+    void Swapchain::captureImage(uint32_t imageIndex, const std::string& filepath)
+    {
+        if (!is_offscreen())
+            throw std::runtime_error("failed to capture frame: only offscreen images can be read back!");
+
+        //  captures are meant for image comparisons, so simply waiting for the frame is fine here
+        vkQueueWaitIdle(device_.get_graphics_queue());
+
+        uint32_t     width   =  swapchainextent_.width;
+        uint32_t     height  = swapchainextent_.height;
+        VkDeviceSize rowsize =  VkDeviceSize{width} * 4;
+
+        VKBuffmanager::Buffmanager readback {device_, rowsize, height, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT};
+        readback.map();
+
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level              =                VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool        =                          device_.get_cmdpool();
+        allocInfo.commandBufferCount =                                              1;
+
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(device_.get_logic(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+            throw std::runtime_error("failed to allocate capture command buffer!");
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags =  VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+        //  the render pass left the image in TRANSFER_SRC_OPTIMAL, only its writes have to be made visible
+        VkImageMemoryBarrier barrier{};
+        barrier.sType                           =   VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask                   =     VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask                   =              VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout                       =     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout                       =     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcQueueFamilyIndex             =                  VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex             =                  VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                           =              swapchainimages_[imageIndex];
+        barrier.subresourceRange.aspectMask     =                VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel   =                                        0;
+        barrier.subresourceRange.levelCount     =                                        1;
+        barrier.subresourceRange.baseArrayLayer =                                        0;
+        barrier.subresourceRange.layerCount     =                                        1;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region{};
+        region.bufferOffset                    =                         0;
+        region.bufferRowLength                 =                         0;
+        region.bufferImageHeight               =                         0;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       =                         0;
+        region.imageSubresource.baseArrayLayer =                         0;
+        region.imageSubresource.layerCount     =                         1;
+        region.imageOffset                     =                 {0, 0, 0};
+        region.imageExtent                     =        {width, height, 1};
+
+        vkCmdCopyImageToBuffer(commandBuffer, swapchainimages_[imageIndex], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               readback.getBuffer(), 1, &region);
+
+        VkBufferMemoryBarrier hostBarrier{};
+        hostBarrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        hostBarrier.srcAccessMask       =            VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask       =                VK_ACCESS_HOST_READ_BIT;
+        hostBarrier.srcQueueFamilyIndex =                 VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.dstQueueFamilyIndex =                 VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.buffer              =                    readback.getBuffer();
+        hostBarrier.offset              =                                       0;
+        hostBarrier.size                =                           VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+
+        vkEndCommandBuffer(commandBuffer);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount =                             1;
+        submitInfo.pCommandBuffers    =                &commandBuffer;
+
+        if (vkQueueSubmit(device_.get_graphics_queue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+            throw std::runtime_error("failed to submit capture command buffer!");
+
+        vkQueueWaitIdle(device_.get_graphics_queue());
+        vkFreeCommandBuffers(device_.get_logic(), device_.get_cmdpool(), 1, &commandBuffer);
+
+        readback.invalidate();
+
+        //  binary PPM keeps RGB only, alpha of the RGBA pixels is dropped
+        std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open " + filepath + "!");
+
+        file << "P6\n" << width << " " << height << "\n255\n";
+
+        auto pixels = static_cast<const unsigned char *>(readback.getMappedMemory());
+        std::vector<char> row (width * 3);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+                for (uint32_t channel = 0; channel < 3; ++channel)
+                    row[x * 3 + channel] = static_cast<char>(pixels[y * rowsize + x * 4 + channel]);
+
+            file.write(row.data(), static_cast<std::streamsize>(row.size()));
+        }
+
+        if (!file)
+            throw std::runtime_error("failed to write " + filepath + "!");
+    }
+
+}   //  end of VKSwapchain namespace
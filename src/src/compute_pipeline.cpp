@@ -0,0 +1,43 @@
+#include "pipeline.hpp"
+
+#include <cassert>
+
+namespace VKPipeline
+{
+
+    ComputePipeline::ComputePipeline(VKDevice::Device& device, const std::string& shaderpath, VkPipelineLayout pipelineLayout)
+                                     : device_{device.get_logic()}, pipelinecache_{device.get_pipeline_cache()}
+    {
+        assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no pipelineLayout provided");
+
+        shadermodule_ = createShaderModule(Service::readfile(shaderpath), device_);
+
+        VkPipelineShaderStageCreateInfo shaderStageInfo{};
+        shaderStageInfo.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        shaderStageInfo.stage  =                         VK_SHADER_STAGE_COMPUTE_BIT;
+        shaderStageInfo.module =                                       shadermodule_;
+        shaderStageInfo.pName  =                                              "main";
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType              = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage              =                                 shaderStageInfo;
+        pipelineInfo.layout             =                                  pipelineLayout;
+        pipelineInfo.basePipelineIndex  =                                              -1;
+        pipelineInfo.basePipelineHandle =                                  VK_NULL_HANDLE;
+
+        if (vkCreateComputePipelines(device_, pipelinecache_, 1, &pipelineInfo, nullptr, &computepipeline_) != VK_SUCCESS)
+            throw std::runtime_error("failed to create compute pipeline!");
+    }
+
+    ComputePipeline::~ComputePipeline()
+    {
+        vkDestroyShaderModule(device_,    shadermodule_, nullptr);
+        vkDestroyPipeline    (device_, computepipeline_, nullptr);
+    }
+
+    void ComputePipeline::bind(VkCommandBuffer commandBuffer)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computepipeline_);
+    }
+
+}   //  end of VKPipeline namespace
@@ -0,0 +1,133 @@
+#include "cpu_profiler.hpp"
+
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace VKProfiler
+{
+    namespace
+    {
+        struct Zone
+        {
+            const char*  name;
+            uint64_t    begin;
+            uint64_t      end;
+        };
+
+        //  written by its thread only; owned by the registry so zones of finished threads can still be written out
+        struct ThreadBuffer
+        {
+            std::unique_ptr<Zone[]>         zones;
+            std::atomic<uint64_t>       count {0};   //  zones recorded so far, the last CPU_ZONE_CAPACITY of them are kept
+            uint32_t                           id;
+            std::string                      name;
+        };
+
+        struct Registry
+        {
+            std::mutex                                       mutex;
+            std::vector<std::unique_ptr<ThreadBuffer>>     threads;
+
+            //  ticks and time at startup; with the ticks and time of writing they give the tick rate
+            uint64_t                                   originticks = cpuTicks();
+            std::chrono::steady_clock::time_point       origintime = std::chrono::steady_clock::now();
+        };
+
+        Registry& registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        ThreadBuffer& threadBuffer()
+        {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (buffer == nullptr)
+            {
+                auto& threads = registry();
+                std::lock_guard<std::mutex> lock {threads.mutex};
+
+                auto created   = std::make_unique<ThreadBuffer>();
+                created->zones = std::make_unique<Zone[]>(CPU_ZONE_CAPACITY);
+                created->id    = static_cast<uint32_t>(threads.threads.size());
+
+                buffer = created.get();
+                threads.threads.push_back(std::move(created));
+            }
+            return *buffer;
+        }
+    }
+
+    void recordZone(const char* name, uint64_t begin, uint64_t end)
+    {
+        auto& buffer = threadBuffer();
+        auto  count  = buffer.count.load(std::memory_order_relaxed);
+
+        buffer.zones[count % CPU_ZONE_CAPACITY] = {name, begin, end};
+        buffer.count.store(count + 1, std::memory_order_release);
+    }
+
+    void nameThread(const char* name)
+    {
+        auto& buffer = threadBuffer();
+
+        std::lock_guard<std::mutex> lock {registry().mutex};
+        buffer.name = name;
+    }
+
+    void writeChromeTrace(std::ostream& stream)
+    {
+        auto& threads = registry();
+        std::lock_guard<std::mutex> lock {threads.mutex};
+
+        auto   ticks        = cpuTicks();
+        double microseconds = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - threads.origintime).count();
+        double ticksperus   = microseconds > 0.0 ? static_cast<double>(ticks - threads.originticks) / microseconds : 1.0;
+
+        auto toMicroseconds = [&](uint64_t tick) { return static_cast<double>(static_cast<int64_t>(tick - threads.originticks)) / ticksperus; };
+
+        stream << std::fixed << std::setprecision(3);
+        stream << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+
+        bool first = true;
+        auto separator = [&]() -> const char* { auto text = first ? "\n" : ",\n"; first = false; return text; };
+
+        for (const auto& buffer : threads.threads)
+        {
+            std::string name = buffer->name.empty() ? "thread " + std::to_string(buffer->id) : buffer->name;
+            stream << separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->id
+                   << ", \"args\": {\"name\": \"" << name << "\"}}";
+
+            auto count = buffer->count.load(std::memory_order_acquire);
+            for (auto index = count - std::min<uint64_t>(count, CPU_ZONE_CAPACITY); index < count; ++index)
+            {
+                const auto& zone = buffer->zones[index % CPU_ZONE_CAPACITY];
+
+                //  zone names are identifiers from the code, nothing in them needs escaping
+                stream << separator() << "{\"name\": \"" << zone.name << "\", \"cat\": \"cpu\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->id
+                       << ", \"ts\": " << toMicroseconds(zone.begin) << ", \"dur\": " << static_cast<double>(zone.end - zone.begin) / ticksperus << "}";
+            }
+        }
+
+        stream << "\n]}\n";
+    }
+
+    void dumpChromeTrace(const std::string& filepath)
+    {
+        std::ofstream file(filepath, std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open " + filepath + "!");
+
+        writeChromeTrace(file);
+
+        if (!file)
+            throw std::runtime_error("failed to write " + filepath + "!");
+    }
+
+}   //  end of VKProfiler namespace
@@ -31,13 +31,19 @@ namespace VKInstance
         return true;
     }
 
-    std::vector<const char*> getRequiredExtensions(bool enableValidationLayers) 
+    std::vector<const char*> getRequiredExtensions(bool enableValidationLayers, bool enableSurface) 
     {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        std::vector<const char*> extensions;
 
-        std::vector<const char*> extensions (glfwExtensions, glfwExtensions + glfwExtensionCount);
+        //  surface extensions come from GLFW, a headless instance does not need any of them
+        if (enableSurface)
+        {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions;
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (enableValidationLayers)
             extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -10,7 +10,8 @@ namespace VKDescriptors
 
 //  builder of descriptor set layout    //
     DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::addBinding(uint32_t binding, VkDescriptorType descriptorType,
-                                                                           VkShaderStageFlags stageFlags, uint32_t count) 
+                                                                           VkShaderStageFlags stageFlags, uint32_t count,
+                                                                           VkDescriptorBindingFlags flags) 
     {
         assert(bindings.count(binding) == 0 && "Binding already in use");
 
@@ -21,27 +22,50 @@ namespace VKDescriptors
         layoutBinding.stageFlags      =     stageFlags;
         bindings[binding]             =  layoutBinding;
 
+        if (flags != 0)
+            bindingFlags[binding] = flags;
+
+        return *this;
+    }
+
+    DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::setLayoutFlags(VkDescriptorSetLayoutCreateFlags flags)
+    {
+        layoutFlags = flags;
         return *this;
     }
 
     std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build() const 
     {
-        return std::make_unique<DescriptorSetLayout>(device_, bindings);
+        return std::make_unique<DescriptorSetLayout>(device_, bindings, bindingFlags, layoutFlags);
     }
 
 
 //  descriptor set layout   //
-    DescriptorSetLayout::DescriptorSetLayout(VKDevice::Device & device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings)
-    : device_{device}, bindings{bindings} 
+    DescriptorSetLayout::DescriptorSetLayout(VKDevice::Device & device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+                                             std::unordered_map<uint32_t, VkDescriptorBindingFlags> bindingFlags, VkDescriptorSetLayoutCreateFlags layoutFlags)
+    : device_{device}, bindings{bindings}, bindingFlags{bindingFlags}
     {
         std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
+        std::vector<VkDescriptorBindingFlags>     setBindingFlags{};
         for (auto kv : bindings)
+        {
             setLayoutBindings.push_back(kv.second);
 
+            auto flags = bindingFlags.find(kv.first);
+            setBindingFlags.push_back(flags == bindingFlags.end() ? 0 : flags->second);
+        }
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        bindingFlagsInfo.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount  =                     static_cast<uint32_t>(setBindingFlags.size());
+        bindingFlagsInfo.pBindingFlags =                                            setBindingFlags.data();
+
         VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
         descriptorSetLayoutInfo.sType        = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutInfo.flags        =                                         layoutFlags;
         descriptorSetLayoutInfo.bindingCount =     static_cast<uint32_t>(setLayoutBindings.size());
         descriptorSetLayoutInfo.pBindings    =                            setLayoutBindings.data();
+        descriptorSetLayoutInfo.pNext        =       bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
  
         if (vkCreateDescriptorSetLayout(device_.get_logic(), &descriptorSetLayoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS)
             throw std::runtime_error("failed to create descriptor set layout!");
@@ -168,6 +192,27 @@ namespace VKDescriptors
         return *this;
     }
  
+    DescriptorWriter &DescriptorWriter::writeImageAt(uint32_t binding, uint32_t arrayElement, VkDescriptorImageInfo *imageInfo)
+    {
+        assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+
+        auto &bindingDescription = setLayout.bindings[binding];
+
+        assert(arrayElement < bindingDescription.descriptorCount && "Array element is out of the binding");
+
+        VkWriteDescriptorSet write{};
+        write.sType           = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.descriptorType  =      bindingDescription.descriptorType;
+        write.dstBinding      =                                binding;
+        write.dstArrayElement =                           arrayElement;
+        write.pImageInfo      =                              imageInfo;
+        write.descriptorCount =                                      1;
+
+        writes.push_back(write);
+
+        return *this;
+    }
+ 
     bool DescriptorWriter::build(VkDescriptorSet &set) 
     {
         bool success = pool.allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
@@ -1,4 +1,9 @@
 #include "device.hpp"
+#include "upload_context.hpp"
+#include "bindless.hpp"
+
+#include <utility>
+#include <algorithm>
 
 namespace VKDevice
 {
@@ -8,46 +13,53 @@ namespace VKDevice
         pickPhysicalDevice(instance);
         createLogicalDevice(instance);
         createCommandPool();
+        createPipelineCache();
+        pickTextureFormats();
+
+        allocator_ = std::make_unique<VKAllocator::Allocator>(physdevice_, logicdevice_, properties_);
+        uploader_  = std::make_unique<VKUpload::UploadContext>(*this);
+        textures_  = std::make_unique<VKBindless::TextureArray>(*this);
     }
 
     Device::~Device()
     {
+        textures_.reset();
+        uploader_.reset();
+        allocator_.reset();
+
+        savePipelineCache();
+        vkDestroyPipelineCache(logicdevice_, pipelinecache_, nullptr);
+
         vkDestroyCommandPool(logicdevice_, commandpool_, nullptr);
         vkDestroyDevice(logicdevice_, nullptr);
     }
 
-    VkCommandBuffer Device::beginSingleTimeCommands() 
+    void Device::pickTextureFormats()
     {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level              =                VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool        =                                   commandpool_;
-        allocInfo.commandBufferCount =                                              1;
+        //  BC7 keeps the quality of the source at a quarter of its size, BC1 halves that again but has one bit of alpha
+        const std::pair<VkFormat, bool> candidates[] = {{VK_FORMAT_BC7_SRGB_BLOCK,           texturecompressionbc_},
+                                                        {VK_FORMAT_BC1_RGBA_SRGB_BLOCK,      texturecompressionbc_},
+                                                        {VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, texturecompressionetc2_}};
 
-        VkCommandBuffer commandBuffer;
-        vkAllocateCommandBuffers(logicdevice_, &allocInfo, &commandBuffer);
+        VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT |
+                                        VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
 
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType              =    VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags              =    VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        for (auto [format, enabled] : candidates)
+        {
+            if (!enabled)
+                continue;
+
+            VkFormatProperties formatProperties;
+            vkGetPhysicalDeviceFormatProperties(physdevice_, format, &formatProperties);
 
-        vkBeginCommandBuffer(commandBuffer, &beginInfo);
-        return commandBuffer;
+            if ((formatProperties.optimalTilingFeatures & required) == required)
+                textureformats_.push_back(format);
+        }
     }
 
-    void Device::endSingleTimeCommands(VkCommandBuffer commandBuffer)
+    bool Device::supports_texture_format(VkFormat format) const
     {
-        vkEndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType              = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount =                             1;
-        submitInfo.pCommandBuffers    =                &commandBuffer;
-
-        vkQueueSubmit(graphics_queue_, 1, &submitInfo, VK_NULL_HANDLE);
-        vkQueueWaitIdle(graphics_queue_);
-
-        vkFreeCommandBuffers(logicdevice_, commandpool_, 1, &commandBuffer);
+        return std::find(textureformats_.begin(), textureformats_.end(), format) != textureformats_.end();
     }
 
     uint32_t Device::findMemoryType(VkPhysicalDevice physicalDevice, uint32_t typeFilter, VkMemoryPropertyFlags properties)
@@ -62,7 +74,7 @@ namespace VKDevice
     }
 
     void Device::createBuffer(VkDeviceSize size,VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
-                      VkBuffer &buffer, VkDeviceMemory &bufferMemory) 
+                      VkBuffer &buffer, VKAllocator::Allocation &allocation, void* owner) 
     {
         VkBufferCreateInfo bufferInfo{};
         bufferInfo.sType       = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
@@ -76,94 +88,19 @@ namespace VKDevice
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(logicdevice_, buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize  = memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(physdevice_, memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(logicdevice_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
-            throw std::runtime_error("failed to allocate vertex buffer memory!");
-
-        vkBindBufferMemory(logicdevice_, buffer, bufferMemory, 0);
-    }
-
-    void Device::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
-    {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferCopy copyRegion {};
-        copyRegion.size      = size;
-        vkCmdCopyBuffer (commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+        allocation = allocator_->allocate(memRequirements, properties, true, owner);
 
-        endSingleTimeCommands(commandBuffer);
+        vkBindBufferMemory(logicdevice_, buffer, allocation.memory, allocation.offset);
     }
 
-    void Device::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
+    void Device::destroyBuffer(VkBuffer buffer, VKAllocator::Allocation &allocation)
     {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferImageCopy region{};
-        region.bufferOffset                    =                         0;
-        region.bufferRowLength                 =                         0;
-        region.bufferImageHeight               =                         0;
-        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel       =                         0;
-        region.imageSubresource.baseArrayLayer =                         0;
-        region.imageSubresource.layerCount     =                         1;
-        region.imageOffset                     =                 {0, 0, 0};
-        region.imageExtent                     =        {width, height, 1};
-
-        vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        endSingleTimeCommands(commandBuffer);
+        vkDestroyBuffer(logicdevice_, buffer, nullptr);
+        allocator_->free(allocation);
     }
 
-    void Device::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout)
-    {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkImageMemoryBarrier barrier{};
-        barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout                       =                              oldLayout;
-        barrier.newLayout                       =                              newLayout;
-        barrier.srcQueueFamilyIndex             =                VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex             =                VK_QUEUE_FAMILY_IGNORED;
-        barrier.image                           =                                  image;
-        barrier.subresourceRange.aspectMask     =              VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseMipLevel   =                                      0;
-        barrier.subresourceRange.levelCount     =                                      1;
-        barrier.subresourceRange.baseArrayLayer =                                      0;
-        barrier.subresourceRange.layerCount     =                                      1;
-
-        VkPipelineStageFlags sourceStage;
-        VkPipelineStageFlags destinationStage;
-
-        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
-        {
-            barrier.srcAccessMask =                                     0;
-            barrier.dstAccessMask =          VK_ACCESS_TRANSFER_WRITE_BIT;
-    
-            sourceStage           =     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage      =        VK_PIPELINE_STAGE_TRANSFER_BIT;
-        }
-        else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
-        {
-            barrier.srcAccessMask =          VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask =             VK_ACCESS_SHADER_READ_BIT;
-
-            sourceStage           =        VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destinationStage      = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        }
-        else
-            throw std::invalid_argument("unsupported layout transition!");
-
-        vkCmdPipelineBarrier (commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
-    void Device::createImage(uint32_t width, uint32_t height, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, 
-                     VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) 
+    void Device::createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage, 
+                     VkMemoryPropertyFlags properties, VkImage& image, VKAllocator::Allocation& allocation, void* owner) 
     {
         VkImageCreateInfo imageInfo{};
         imageInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -171,7 +108,7 @@ namespace VKDevice
         imageInfo.extent.width  =                               width;
         imageInfo.extent.height =                              height;
         imageInfo.extent.depth  =                                   1;
-        imageInfo.mipLevels     =                                   1;
+        imageInfo.mipLevels     =                           mipLevels;
         imageInfo.arrayLayers   =                                   1;
         imageInfo.format        =                              format;
         imageInfo.tiling        =                              tiling;
@@ -180,24 +117,32 @@ namespace VKDevice
         imageInfo.samples       =               VK_SAMPLE_COUNT_1_BIT;
         imageInfo.sharingMode   =           VK_SHARING_MODE_EXCLUSIVE;
 
+        createImageWithInfo(imageInfo, properties, image, allocation, owner);
+    }
+
+    void Device::createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties,
+                                     VkImage &image, VKAllocator::Allocation &allocation, void* owner)
+    {
         if (vkCreateImage(logicdevice_, &imageInfo, nullptr, &image) != VK_SUCCESS)
             throw std::runtime_error("failed to create image!");
 
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(logicdevice_, image, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType           =                                        VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize  =                                                          memRequirements.size;
-        allocInfo.memoryTypeIndex = findMemoryType(physdevice_, memRequirements.memoryTypeBits, properties);
+        //  linear and optimal resources live in different blocks, so bufferImageGranularity never has to be respected inside a block
+        allocation = allocator_->allocate(memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_LINEAR, owner);
 
-        if (vkAllocateMemory(logicdevice_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-            throw std::runtime_error("failed to allocate image memory!");
+        if (vkBindImageMemory(logicdevice_, image, allocation.memory, allocation.offset) != VK_SUCCESS)
+            throw std::runtime_error("failed to bind image memory!");
+    }
 
-        vkBindImageMemory(logicdevice_, image, imageMemory, 0);
+    void Device::destroyImage(VkImage image, VKAllocator::Allocation &allocation)
+    {
+        vkDestroyImage(logicdevice_, image, nullptr);
+        allocator_->free(allocation);
     }
 
-    VkImageView Device::createImageView(VkImage image, VkFormat format)
+    VkImageView Device::createImageView(VkImage image, VkFormat format, uint32_t mipLevels)
     {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType                           = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -206,7 +151,7 @@ namespace VKDevice
         viewInfo.format                          =                                   format;
         viewInfo.subresourceRange.aspectMask     =                VK_IMAGE_ASPECT_COLOR_BIT;
         viewInfo.subresourceRange.baseMipLevel   =                                        0;
-        viewInfo.subresourceRange.levelCount     =                                        1;
+        viewInfo.subresourceRange.levelCount     =                                mipLevels;
         viewInfo.subresourceRange.baseArrayLayer =                                        0;
         viewInfo.subresourceRange.layerCount     =                                        1;
 
@@ -0,0 +1,69 @@
+#include "frame_arena.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+namespace VKFrameArena
+{
+
+    FrameArena::FrameArena(std::size_t capacity)
+    {
+        blocks_.push_back({std::make_unique_for_overwrite<std::byte[]>(capacity), capacity});
+    }
+
+    void* FrameArena::allocate(std::size_t size, std::size_t alignment)
+    {
+        assert((alignment & (alignment - 1)) == 0 && "Alignment has to be a power of two");
+
+        for (;;)
+        {
+            auto& block   = blocks_[block_];
+            auto  address = reinterpret_cast<std::uintptr_t>(block.data.get()) + offset_;
+            auto  padding = (alignment - address % alignment) % alignment;
+
+            if (offset_ + padding + size <= block.size)
+            {
+                offset_ += padding + size;
+                used_   += padding + size;
+                peak_    = std::max(peak_, used_);
+
+                return block.data.get() + offset_ - size;
+            }
+
+            //  the rest of this block is wasted for this frame, the merge on reset gives it back
+            if (++block_ == blocks_.size())
+            {
+                std::size_t blocksize = std::max(blocks_.back().size * 2, size + alignment);
+                blocks_.push_back({std::make_unique_for_overwrite<std::byte[]>(blocksize), blocksize});
+            }
+            used_  += blocks_[block_ - 1].size - offset_;
+            offset_ = 0;
+        }
+    }
+
+    void FrameArena::reset()
+    {
+        if (blocks_.size() > 1)
+        {
+            std::size_t capacity = get_capacity();
+
+            blocks_.clear();
+            blocks_.push_back({std::make_unique_for_overwrite<std::byte[]>(capacity), capacity});
+        }
+
+        block_  = 0;
+        offset_ = 0;
+        used_   = 0;
+    }
+
+    std::size_t FrameArena::get_capacity() const
+    {
+        std::size_t capacity = 0;
+        for (const auto& block : blocks_)
+            capacity += block.size;
+
+        return capacity;
+    }
+
+}   //  end of VKFrameArena namespace
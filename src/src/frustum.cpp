@@ -0,0 +1,97 @@
+#include "frustum.hpp"
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace VKFrustum
+{
+
+    Frustum::Frustum(const glm::mat4& projectionView)
+    {
+        //  glm is column major, rows of the matrix are gathered by hand
+        auto row = [&projectionView](int index)
+        {
+            return glm::vec4{projectionView[0][index], projectionView[1][index], projectionView[2][index], projectionView[3][index]};
+        };
+
+        planes_[0] = row(3) + row(0);   //  left
+        planes_[1] = row(3) - row(0);   //  right
+        planes_[2] = row(3) + row(1);   //  top or bottom, depending on the flip of y
+        planes_[3] = row(3) - row(1);
+        planes_[4] =          row(2);   //  near, because depth starts at zero
+        planes_[5] = row(3) - row(2);   //  far
+
+        //  normalized planes give true distances, which are compared against the radii
+        for (auto& plane : planes_)
+            plane /= glm::length(glm::vec3{plane});
+    }
+
+    void cullSpheres(const Frustum& frustum, const Spheres& spheres, std::vector<uint8_t>& visible)
+    {
+        const auto& planes = frustum.get_planes();
+        std::size_t count  =      spheres.size();
+        std::size_t index  =                   0;
+
+        visible.resize(count);
+
+#if defined(__AVX__)
+        for (; index + 8 <= count; index += 8)
+        {
+            __m256 x = _mm256_loadu_ps(spheres.x.data() + index);
+            __m256 y = _mm256_loadu_ps(spheres.y.data() + index);
+            __m256 z = _mm256_loadu_ps(spheres.z.data() + index);
+            __m256 r = _mm256_loadu_ps(spheres.radius.data() + index);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const auto& plane : planes)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(plane.x)),
+                                                              _mm256_mul_ps(y, _mm256_set1_ps(plane.y))),
+                                                _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(plane.z)),
+                                                              _mm256_set1_ps(plane.w)));
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_sub_ps(_mm256_setzero_ps(), r), _CMP_GE_OQ));
+            }
+
+            int mask = _mm256_movemask_ps(inside);
+            for (int lane = 0; lane < 8; ++lane)
+                visible[index + lane] = (mask >> lane) & 1;
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; index + 4 <= count; index += 4)
+        {
+            __m128 x = _mm_loadu_ps(spheres.x.data() + index);
+            __m128 y = _mm_loadu_ps(spheres.y.data() + index);
+            __m128 z = _mm_loadu_ps(spheres.z.data() + index);
+            __m128 r = _mm_loadu_ps(spheres.radius.data() + index);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const auto& plane : planes)
+            {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(plane.x)),
+                                                        _mm_mul_ps(y, _mm_set1_ps(plane.y))),
+                                             _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(plane.z)),
+                                                        _mm_set1_ps(plane.w)));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_sub_ps(_mm_setzero_ps(), r)));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4; ++lane)
+                visible[index + lane] = (mask >> lane) & 1;
+        }
+#endif
+
+        //  tail of the batches, or everything without SIMD
+        for (; index < count; ++index)
+        {
+            uint8_t inside = 1;
+            for (const auto& plane : planes)
+                inside &= plane.x * spheres.x[index] + plane.y * spheres.y[index] + plane.z * spheres.z[index] + plane.w >= -spheres.radius[index];
+
+            visible[index] = inside;
+        }
+    }
+
+}   //  end of VKFrustum namespace
@@ -0,0 +1,293 @@
+#include "gpu_profiler.hpp"
+
+#include <limits>
+#include <cassert>
+#include <fstream>
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+namespace VKProfiler
+{
+    namespace
+    {
+        //  names of GPU_STATISTICS in the order of their bits
+        constexpr std::array<const char*, GPU_STATISTIC_COUNT> STATISTIC_NAMES {"input_vertices", "input_primitives", "vertex_invocations",
+                                                                                "clipped_primitives", "fragment_invocations", "compute_invocations"};
+
+        struct Summary
+        {
+            uint32_t                                       samples = 0;
+            float                                         average = 0.0f;
+            float                                         minimum = 0.0f;
+            float                                         maximum = 0.0f;
+            uint32_t                             statisticsamples = 0;
+            std::array<double, GPU_STATISTIC_COUNT>     statistics {};
+        };
+
+        template <typename Record>
+        Summary summarize(const Record& record)
+        {
+            Summary summary{};
+            summary.samples = std::min(record.count, GPU_PROFILE_WINDOW);
+            if (summary.samples == 0)
+                return summary;
+
+            summary.minimum = std::numeric_limits<float>::max();
+            for (uint32_t index = 0; index < summary.samples; ++index)
+            {
+                const auto& sample = record.samples[index];
+
+                summary.average += sample.milliseconds;
+                summary.minimum  = std::min(summary.minimum, sample.milliseconds);
+                summary.maximum  = std::max(summary.maximum, sample.milliseconds);
+
+                if (!sample.hasstatistics)
+                    continue;
+
+                ++summary.statisticsamples;
+                for (uint32_t statistic = 0; statistic < GPU_STATISTIC_COUNT; ++statistic)
+                    summary.statistics[statistic] += static_cast<double>(sample.statistics[statistic]);
+            }
+
+            summary.average /= static_cast<float>(summary.samples);
+            if (summary.statisticsamples != 0)
+                for (auto& statistic : summary.statistics)
+                    statistic /= summary.statisticsamples;
+
+            return summary;
+        }
+    }
+
+    GpuProfiler::GpuProfiler (VKDevice::Device& device) : device_{device}
+    {
+        uint32_t familycount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device_.get_phys(), &familycount, nullptr);
+        std::vector<VkQueueFamilyProperties> families (familycount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device_.get_phys(), &familycount, families.data());
+
+        //  ticks wrap around after timestampValidBits, a queue without valid bits can not write timestamps at all
+        uint32_t validbits = families[device_.get_indices().get_graphics_value()].timestampValidBits;
+        if (validbits == 0)
+            return;
+
+        enabled_         =                                                                   true;
+        hasstatistics_   =                                 device_.supports_pipeline_statistics();
+        timestampperiod_ =                           device_.get_properties().limits.timestampPeriod;
+        timestampmask_   = validbits >= 64 ? ~0ull : (1ull << validbits) - 1;
+
+        for (auto& frame : frames_)
+        {
+            VkQueryPoolCreateInfo poolInfo{};
+            poolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            poolInfo.queryType  =                VK_QUERY_TYPE_TIMESTAMP;
+            poolInfo.queryCount =                     MAX_GPU_SCOPES * 2;
+
+            if (vkCreateQueryPool(device_.get_logic(), &poolInfo, nullptr, &frame.timestamps_) != VK_SUCCESS)
+                throw std::runtime_error("failed to create timestamp query pool!");
+
+            if (!hasstatistics_)
+                continue;
+
+            poolInfo.queryType          = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+            poolInfo.queryCount         =                     MAX_GPU_SCOPES;
+            poolInfo.pipelineStatistics =                     GPU_STATISTICS;
+
+            if (vkCreateQueryPool(device_.get_logic(), &poolInfo, nullptr, &frame.statistics_) != VK_SUCCESS)
+                throw std::runtime_error("failed to create pipeline statistics query pool!");
+        }
+
+        timestamps_.resize(MAX_GPU_SCOPES * 2);
+        statistics_.resize(MAX_GPU_SCOPES * GPU_STATISTIC_COUNT);
+    }
+
+    GpuProfiler::~GpuProfiler()
+    {
+        for (auto& frame : frames_)
+        {
+            vkDestroyQueryPool(device_.get_logic(), frame.timestamps_, nullptr);
+            vkDestroyQueryPool(device_.get_logic(), frame.statistics_, nullptr);
+        }
+    }
+
+    void GpuProfiler::beginFrame(VkCommandBuffer commandbuffer, uint32_t frameindex)
+    {
+        if (!enabled_)
+            return;
+
+        assert(activestatistic_ == INVALID_SCOPE && depth_ == 0 && "Scopes of the previous frame were not ended");
+
+        frame_ = &frames_[frameindex];
+        collect(*frame_);
+
+        frame_->scopes_.clear();
+        frame_->statisticcount_ = 0;
+        ++framecount_;
+
+        vkCmdResetQueryPool(commandbuffer, frame_->timestamps_, 0, MAX_GPU_SCOPES * 2);
+        if (hasstatistics_)
+            vkCmdResetQueryPool(commandbuffer, frame_->statistics_, 0, MAX_GPU_SCOPES);
+    }
+
+    uint32_t GpuProfiler::beginScope(VkCommandBuffer commandbuffer, const char* name, bool statistics)
+    {
+        if (!enabled_ || frame_ == nullptr || frame_->scopes_.size() == MAX_GPU_SCOPES)
+            return INVALID_SCOPE;
+
+        uint32_t scope = static_cast<uint32_t>(frame_->scopes_.size());
+        frame_->scopes_.push_back({name, depth_++, INVALID_SCOPE, false});
+
+        vkCmdWriteTimestamp(commandbuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, frame_->timestamps_, scope * 2);
+
+        if (statistics && hasstatistics_ && activestatistic_ == INVALID_SCOPE)
+        {
+            activestatistic_                    = scope;
+            frame_->scopes_[scope].statistic_ = frame_->statisticcount_++;
+
+            vkCmdBeginQuery(commandbuffer, frame_->statistics_, frame_->scopes_[scope].statistic_, 0);
+        }
+
+        return scope;
+    }
+
+    void GpuProfiler::endScope(VkCommandBuffer commandbuffer, uint32_t scope)
+    {
+        if (scope == INVALID_SCOPE)
+            return;
+
+        auto& current = frame_->scopes_[scope];
+        assert(!current.ended_ && current.depth_ + 1 == depth_ && "Scopes have to be ended in reverse order");
+
+        if (activestatistic_ == scope)
+        {
+            vkCmdEndQuery(commandbuffer, frame_->statistics_, current.statistic_);
+            activestatistic_ = INVALID_SCOPE;
+        }
+
+        vkCmdWriteTimestamp(commandbuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, frame_->timestamps_, scope * 2 + 1);
+
+        current.ended_ = true;
+        --depth_;
+    }
+
+    void GpuProfiler::collect(Frame& frame)
+    {
+        uint32_t scopecount = static_cast<uint32_t>(frame.scopes_.size());
+        if (scopecount == 0)
+            return;
+
+        //  the frame's fence was waited for, so results are normally there; if not, the frame is skipped rather than waited on
+        auto result = vkGetQueryPoolResults(device_.get_logic(), frame.timestamps_, 0, scopecount * 2,
+                                            timestamps_.size() * sizeof(uint64_t), timestamps_.data(), sizeof(uint64_t),
+                                            VK_QUERY_RESULT_64_BIT);
+        if (result != VK_SUCCESS)
+            return;
+
+        if (frame.statisticcount_ != 0)
+        {
+            result = vkGetQueryPoolResults(device_.get_logic(), frame.statistics_, 0, frame.statisticcount_,
+                                           statistics_.size() * sizeof(uint64_t), statistics_.data(),
+                                           GPU_STATISTIC_COUNT * sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+            if (result != VK_SUCCESS)
+                return;
+        }
+
+        for (uint32_t scope = 0; scope < scopecount; ++scope)
+        {
+            const auto& current = frame.scopes_[scope];
+            if (!current.ended_)
+                continue;
+
+            uint64_t ticks = (timestamps_[scope * 2 + 1] - timestamps_[scope * 2]) & timestampmask_;
+
+            auto& entry  = record(current.name_, current.depth_);
+            auto& sample = entry.samples[entry.count++ % GPU_PROFILE_WINDOW];
+
+            sample.milliseconds  = static_cast<float>(static_cast<double>(ticks) * timestampperiod_ * 1e-6);
+            sample.hasstatistics =                                           current.statistic_ != INVALID_SCOPE;
+
+            if (sample.hasstatistics)
+                std::copy_n(statistics_.begin() + current.statistic_ * GPU_STATISTIC_COUNT, GPU_STATISTIC_COUNT,
+                            sample.statistics.begin());
+        }
+    }
+
+    GpuProfiler::Record& GpuProfiler::record(const char* name, uint32_t depth)
+    {
+        for (auto& entry : records_)
+            if (entry.name == name)
+                return entry;
+
+        records_.push_back({name, depth, {}, 0});
+        return records_.back();
+    }
+
+    void GpuProfiler::dump(const std::string& filepath) const
+    {
+        std::ofstream file(filepath, std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open " + filepath + "!");
+
+        bool csv = filepath.size() >= 4 && filepath.compare(filepath.size() - 4, 4, ".csv") == 0;
+        if (csv)
+            writeCSV(file);
+        else
+            writeJSON(file);
+
+        if (!file)
+            throw std::runtime_error("failed to write " + filepath + "!");
+    }
+
+    void GpuProfiler::writeJSON(std::ostream& stream) const
+    {
+        stream << std::fixed << std::setprecision(4);
+        stream << "{\n  \"frames\": " << framecount_ << ",\n  \"window\": " << GPU_PROFILE_WINDOW << ",\n  \"scopes\": [";
+
+        for (std::size_t index = 0; index < records_.size(); ++index)
+        {
+            const auto& entry   =    records_[index];
+            auto        summary = summarize(entry);
+
+            stream << (index == 0 ? "\n" : ",\n")
+                   << "    {\"name\": \"" << entry.name << "\", \"depth\": " << entry.depth << ", \"samples\": " << summary.samples
+                   << ", \"avg_ms\": " << summary.average << ", \"min_ms\": " << summary.minimum << ", \"max_ms\": " << summary.maximum;
+
+            if (summary.statisticsamples != 0)
+            {
+                stream << ", \"statistics\": {";
+                for (uint32_t statistic = 0; statistic < GPU_STATISTIC_COUNT; ++statistic)
+                    stream << (statistic == 0 ? "" : ", ") << "\"" << STATISTIC_NAMES[statistic] << "\": "
+                           << std::setprecision(1) << summary.statistics[statistic] << std::setprecision(4);
+                stream << "}";
+            }
+            stream << "}";
+        }
+
+        stream << "\n  ]\n}\n";
+    }
+
+    void GpuProfiler::writeCSV(std::ostream& stream) const
+    {
+        stream << "name,depth,samples,avg_ms,min_ms,max_ms";
+        for (auto name : STATISTIC_NAMES)
+            stream << "," << name;
+        stream << "\n" << std::fixed;
+
+        for (const auto& entry : records_)
+        {
+            auto summary = summarize(entry);
+
+            stream << entry.name << "," << entry.depth << "," << summary.samples << std::setprecision(4) << ","
+                   << summary.average << "," << summary.minimum << "," << summary.maximum << std::setprecision(1);
+
+            //  scopes without statistics leave the columns empty
+            for (auto statistic : summary.statistics)
+                if (summary.statisticsamples != 0)
+                    stream << "," << statistic;
+                else
+                    stream << ",";
+            stream << "\n";
+        }
+    }
+
+}   //  end of VKProfiler namespace
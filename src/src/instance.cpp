@@ -3,11 +3,16 @@
 namespace VKInstance
 {
 
-    Instance::Instance(VKWindow::Window& window)
+    Instance::Instance(VKWindow::Window& window) : enableSwapChain{!window.is_headless()}
     {
         createInstance();
         setupDebugMessenger();
-        createSurface(window);
+
+        if (enableSwapChain)
+        {
+            createSurface(window);
+            deviceExtensions_ = deviceExtensions;
+        }
     }
 
     Instance::~Instance()
@@ -32,13 +37,13 @@ namespace VKInstance
         appInfo.applicationVersion  =           VK_MAKE_VERSION(1, 0, 0);
         appInfo.pEngineName         =                        "No Engine";
         appInfo.engineVersion       =           VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion          =                 VK_API_VERSION_1_0;
+        appInfo.apiVersion          =                 VK_API_VERSION_1_2;
 
         VkInstanceCreateInfo createInfo{};
         createInfo.sType                   =         VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
         createInfo.pApplicationInfo        =                                       &appInfo;
     
-        auto extensions                    =  getRequiredExtensions(enableValidationLayers);
+        auto extensions                    =  getRequiredExtensions(enableValidationLayers, enableSwapChain);
         createInfo.enabledExtensionCount   =       static_cast<uint32_t>(extensions.size());
         createInfo.ppEnabledExtensionNames =                              extensions.data();
 
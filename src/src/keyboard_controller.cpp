@@ -5,7 +5,7 @@
 
 namespace VKKeyboardController 
 {
-    void KeyboardController::moveInPlaneXZ(GLFWwindow* window, float dt, VKObject::Object& object) 
+    void KeyboardController::moveInPlaneXZ(GLFWwindow* window, float dt, VKObject::Transform3Dcomponent& transform) 
     {
         glm::vec3 rotate{0};
         if (glfwGetKey(window, keys.lookRight) == GLFW_PRESS) rotate.y += 10.5f;
@@ -14,13 +14,13 @@ namespace VKKeyboardController
         if (glfwGetKey(window, keys.lookDown) == GLFW_PRESS) rotate.x -= 10.5f;
 
         if (glm::dot(rotate, rotate) > std::numeric_limits<float>::epsilon())
-            object.transform3D_.rotation += lookSpeed * dt * glm::normalize(rotate);
+            transform.rotation += lookSpeed * dt * glm::normalize(rotate);
 
         // limit pitch values between about +/- 85ish degrees
-        object.transform3D_.rotation.x = glm::clamp(object.transform3D_.rotation.x, -1.5f, 1.5f);
-        object.transform3D_.rotation.y = glm::mod(object.transform3D_.rotation.y, glm::two_pi<float>());
+        transform.rotation.x = glm::clamp(transform.rotation.x, -1.5f, 1.5f);
+        transform.rotation.y = glm::mod(transform.rotation.y, glm::two_pi<float>());
 
-        float yaw = object.transform3D_.rotation.y;
+        float yaw = transform.rotation.y;
         const glm::vec3 forwardDir{sin(yaw), 0.f, cos(yaw)};
         const glm::vec3 rightDir{forwardDir.z, 0.f, -forwardDir.x};
         const glm::vec3 upDir{0.f, -1.f, 0.f};
@@ -34,7 +34,7 @@ namespace VKKeyboardController
         if (glfwGetKey(window, keys.moveDown) == GLFW_PRESS) moveDir -= upDir;
 
         if (glm::dot(moveDir, moveDir) > std::numeric_limits<float>::epsilon())
-            object.transform3D_.translation += moveSpeed * dt * glm::normalize(moveDir);
+            transform.translation += moveSpeed * dt * glm::normalize(moveDir);
     }
 
 }  // namespace lve
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include "ktx.hpp"
+
+#include <bit>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <filesystem>
+
+namespace VKKtx
+{
+
+    namespace
+    {
+        constexpr std::array<unsigned char, 12> IDENTIFIER = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+        //  identifier, header and index up to the level index, see the KTX 2.0 specification
+        constexpr std::size_t HEADER_SIZE      = 80;
+        constexpr std::size_t LEVEL_INDEX_SIZE = 24;
+
+        //  khr_df.h values of the basic data format descriptor
+        constexpr uint8_t  KHR_DF_MODEL_BC1A              =  128;
+        constexpr uint8_t  KHR_DF_MODEL_BC7               =  134;
+        constexpr uint8_t  KHR_DF_MODEL_ETC2              =  161;
+        constexpr uint8_t  KHR_DF_PRIMARIES_BT709         =    1;
+        constexpr uint8_t  KHR_DF_TRANSFER_SRGB           =    2;
+        constexpr uint8_t  KHR_DF_CHANNEL_BC1A_ALPHA      =    1;
+        constexpr uint8_t  KHR_DF_CHANNEL_BC7_DATA        =    0;
+        constexpr uint8_t  KHR_DF_CHANNEL_ETC2_COLOR      =    2;
+        constexpr uint8_t  KHR_DF_CHANNEL_ETC2_ALPHA      =   15;
+        constexpr uint16_t KHR_DF_VERSION                 =    2;
+
+        const char* formatName(VkFormat format)
+        {
+            switch (format)
+            {
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:      return "bc1";
+                case VK_FORMAT_BC7_SRGB_BLOCK:           return "bc7";
+                case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK: return "etc2";
+                default:                                 return nullptr;
+            }
+        }
+
+        template <typename T>
+        T load(const std::vector<unsigned char>& data, std::size_t offset)
+        {
+            T value;
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void store(std::vector<unsigned char>& data, T value)
+        {
+            auto bytes = reinterpret_cast<const unsigned char*>(&value);
+            data.insert(data.end(), bytes, bytes + sizeof(T));
+        }
+
+        void pad(std::vector<unsigned char>& data, std::size_t alignment)
+        {
+            data.resize((data.size() + alignment - 1) / alignment * alignment, 0);
+        }
+
+        //  one sample of a descriptor block: bits of a channel inside the texel block
+        void storeSample(std::vector<unsigned char>& data, uint16_t bitoffset, uint8_t bitlength, uint8_t channel)
+        {
+            store<uint16_t>(data,      bitoffset);
+            store<uint8_t> (data, bitlength - 1u);
+            store<uint8_t> (data,        channel);
+            store<uint32_t>(data,              0);   //  sample position
+            store<uint32_t>(data,              0);   //  lower
+            store<uint32_t>(data,     UINT32_MAX);   //  upper
+        }
+
+        std::vector<unsigned char> makeDescriptor(VkFormat format)
+        {
+            uint8_t model = 0;
+            switch (format)
+            {
+                case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:      model = KHR_DF_MODEL_BC1A; break;
+                case VK_FORMAT_BC7_SRGB_BLOCK:           model = KHR_DF_MODEL_BC7;  break;
+                case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK: model = KHR_DF_MODEL_ETC2; break;
+                default: throw std::runtime_error("failed to describe texture format!");
+            }
+
+            uint32_t samples   = format == VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK ? 2 : 1;
+            uint16_t blocksize = static_cast<uint16_t>(24 + 16 * samples);
+
+            std::vector<unsigned char> descriptor;
+            store<uint32_t>(descriptor, 4u + blocksize);   //  total size
+            store<uint32_t>(descriptor, 0);                //  Khronos vendor, basic descriptor type
+            store<uint16_t>(descriptor, KHR_DF_VERSION);
+            store<uint16_t>(descriptor, blocksize);
+            store<uint8_t> (descriptor, model);
+            store<uint8_t> (descriptor, KHR_DF_PRIMARIES_BT709);
+            store<uint8_t> (descriptor, KHR_DF_TRANSFER_SRGB);
+            store<uint8_t> (descriptor, 0);                //  straight alpha
+            store<uint32_t>(descriptor, 0x00000303);       //  4x4x1x1 texel block, stored as dimension - 1
+            store<uint32_t>(descriptor, blockSize(format)); //  bytes of plane 0
+            store<uint32_t>(descriptor, 0);                //  planes 4..7
+
+            if (format == VK_FORMAT_BC1_RGBA_SRGB_BLOCK)
+                storeSample(descriptor, 0, 64, KHR_DF_CHANNEL_BC1A_ALPHA);
+            else if (format == VK_FORMAT_BC7_SRGB_BLOCK)
+                storeSample(descriptor, 0, 128, KHR_DF_CHANNEL_BC7_DATA);
+            else
+            {
+                storeSample(descriptor,  0, 64, KHR_DF_CHANNEL_ETC2_ALPHA);
+                storeSample(descriptor, 64, 64, KHR_DF_CHANNEL_ETC2_COLOR);
+            }
+
+            return descriptor;
+        }
+    }
+
+    VkDeviceSize Texture::getSize() const
+    {
+        VkDeviceSize size = 0;
+        for (auto& level : levels)
+            size += level.size;
+
+        return size;
+    }
+
+    uint32_t blockSize(VkFormat format)
+    {
+        switch (format)
+        {
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:      return  8;
+            case VK_FORMAT_BC7_SRGB_BLOCK:           return 16;
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK: return 16;
+            default:                                 return  0;
+        }
+    }
+
+    VkDeviceSize levelSize(VkFormat format, uint32_t width, uint32_t height)
+    {
+        return VkDeviceSize{(width + 3) / 4} * ((height + 3) / 4) * blockSize(format);
+    }
+
+    std::string compressedPath(const std::string& filepath, VkFormat format)
+    {
+        auto name = formatName(format);
+        if (!name)
+            throw std::runtime_error("failed to name texture format!");
+
+        return std::filesystem::path{filepath}.replace_extension(std::string{name} + ".ktx2").string();
+    }
+
+    std::string findCompressed(const std::string& filepath, std::span<const VkFormat> formats)
+    {
+        if (std::filesystem::path{filepath}.extension() == ".ktx2")
+            return filepath;
+
+        for (auto format : formats)
+        {
+            auto candidate = compressedPath(filepath, format);
+            if (std::filesystem::exists(candidate))
+                return candidate;
+        }
+
+        return std::string{};
+    }
+
+    Texture read(const std::string& filepath)
+    {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open " + filepath + "!");
+
+        Texture texture{};
+        texture.data.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+
+        auto& data = texture.data;
+        if (data.size() < HEADER_SIZE || !std::equal(IDENTIFIER.begin(), IDENTIFIER.end(), data.begin()))
+            throw std::runtime_error("failed to read " + filepath + ": not a KTX2 file!");
+
+        texture.format  = static_cast<VkFormat>(load<uint32_t>(data, 12));
+        texture.width   =                       load<uint32_t>(data, 20);
+        texture.height  =                       load<uint32_t>(data, 24);
+        auto depth      =                       load<uint32_t>(data, 28);
+        auto layers     =                       load<uint32_t>(data, 32);
+        auto faces      =                       load<uint32_t>(data, 36);
+        auto levelcount =                       load<uint32_t>(data, 40);
+        auto scheme     =                       load<uint32_t>(data, 44);
+
+        if (blockSize(texture.format) == 0)
+            throw std::runtime_error("failed to read " + filepath + ": unsupported format!");
+        if (depth != 0 || layers > 1 || faces != 1 || texture.width == 0 || texture.height == 0)
+            throw std::runtime_error("failed to read " + filepath + ": only single 2D images are supported!");
+        if (scheme != 0)
+            throw std::runtime_error("failed to read " + filepath + ": supercompressed files are not supported!");
+        if (levelcount == 0 || data.size() < HEADER_SIZE + levelcount * LEVEL_INDEX_SIZE)
+            throw std::runtime_error("failed to read " + filepath + ": the file has no mip levels!");
+        //  a chain ends with the 1x1 level, floor(log2(max(width, height))) + 1 levels in all
+        if (levelcount > std::bit_width(std::max(texture.width, texture.height)))
+            throw std::runtime_error("failed to read " + filepath + ": more mip levels than the image has!");
+
+        for (uint32_t mip = 0; mip < levelcount; ++mip)
+        {
+            Level level{};
+            level.offset = load<uint64_t>(data, HEADER_SIZE + mip * LEVEL_INDEX_SIZE);
+            level.size   = load<uint64_t>(data, HEADER_SIZE + mip * LEVEL_INDEX_SIZE + 8);
+            level.width  =                      std::max(texture.width  >> mip, 1u);
+            level.height =                      std::max(texture.height >> mip, 1u);
+
+            if (level.size != levelSize(texture.format, level.width, level.height) || level.offset > data.size() ||
+                level.size > data.size() - level.offset)
+                throw std::runtime_error("failed to read " + filepath + ": level data is out of bounds!");
+
+            texture.levels.push_back(level);
+        }
+
+        return texture;
+    }
+
+    void write(const std::string& filepath, const Texture& texture)
+    {
+        auto descriptor = makeDescriptor(texture.format);
+        auto levelcount = static_cast<uint32_t>(texture.levels.size());
+
+        std::vector<unsigned char> data (IDENTIFIER.begin(), IDENTIFIER.end());
+        store<uint32_t>(data, static_cast<uint32_t>(texture.format));
+        store<uint32_t>(data,              1);   //  type size of block-compressed formats
+        store<uint32_t>(data,  texture.width);
+        store<uint32_t>(data, texture.height);
+        store<uint32_t>(data,              0);   //  depth
+        store<uint32_t>(data,              0);   //  layers
+        store<uint32_t>(data,              1);   //  faces
+        store<uint32_t>(data,     levelcount);
+        store<uint32_t>(data,              0);   //  no supercompression
+
+        auto descriptoroffset = static_cast<uint32_t>(HEADER_SIZE + levelcount * LEVEL_INDEX_SIZE);
+        store<uint32_t>(data, descriptoroffset);
+        store<uint32_t>(data, static_cast<uint32_t>(descriptor.size()));
+        store<uint32_t>(data, 0);                //  key/value data
+        store<uint32_t>(data, 0);
+        store<uint64_t>(data, 0);                //  supercompression global data
+        store<uint64_t>(data, 0);
+
+        //  the index lists level 0 first, the data holds the smallest level first, each one aligned to its block
+        std::size_t indexoffset = data.size();
+        data.resize(descriptoroffset, 0);
+        data.insert(data.end(), descriptor.begin(), descriptor.end());
+
+        for (uint32_t mip = levelcount; mip-- > 0;)
+        {
+            auto& level = texture.levels[mip];
+            pad(data, blockSize(texture.format));
+
+            uint64_t index[3] = {data.size(), level.size, level.size};
+            std::memcpy(data.data() + indexoffset + mip * LEVEL_INDEX_SIZE, index, sizeof(index));
+
+            data.insert(data.end(), texture.data.begin() + level.offset, texture.data.begin() + level.offset + level.size);
+        }
+
+        std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            throw std::runtime_error("failed to open " + filepath + "!");
+
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file)
+            throw std::runtime_error("failed to write " + filepath + "!");
+    }
+
+    void downsampleSRGB(const unsigned char* src, int width, int height, std::vector<unsigned char>& dst)
+    {
+        static const auto tolinear = []
+        {
+            std::array<float, 256> table{};
+            for (int i = 0; i < 256; ++i)
+            {
+                float c  = i / 255.0f;
+                table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return table;
+        }();
+
+        auto tosrgb = [](float c)
+        {
+            c = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            return static_cast<unsigned char>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+        };
+
+        int nextwidth  = std::max(width  / 2, 1);
+        int nextheight = std::max(height / 2, 1);
+        dst.resize(static_cast<std::size_t>(nextwidth) * nextheight * 4);
+
+        for (int y = 0; y < nextheight; ++y)
+            for (int x = 0; x < nextwidth; ++x)
+            {
+                int x0 = std::min(2 * x, width - 1),  x1 = std::min(2 * x + 1, width - 1);
+                int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+
+                const unsigned char* texels[4] = {src + (y0 * width + x0) * 4, src + (y0 * width + x1) * 4,
+                                                  src + (y1 * width + x0) * 4, src + (y1 * width + x1) * 4};
+
+                unsigned char* out = dst.data() + (static_cast<std::size_t>(y) * nextwidth + x) * 4;
+                for (int channel = 0; channel < 3; ++channel)
+                {
+                    float sum = 0.0f;
+                    for (auto* texel : texels)
+                        sum += tolinear[texel[channel]];
+                    out[channel] = tosrgb(sum * 0.25f);
+                }
+
+                out[3] = static_cast<unsigned char>((texels[0][3] + texels[1][3] + texels[2][3] + texels[3][3] + 2) / 4);
+            }
+    }
+
+}   //  end of VKKtx namespace
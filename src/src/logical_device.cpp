@@ -6,7 +6,8 @@ namespace VKDevice
     {
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
         std::set<uint32_t> uniqueQueueFamilies = {indices_.get_graphics_value(),
-                                                  indices_.get_present_value()};
+                                                  indices_.get_present_value(),
+                                                  indices_.get_transfer_value()};
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -20,16 +21,47 @@ namespace VKDevice
             queueCreateInfos.push_back(queueCreateInfo);
         }
 
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(physdevice_, &supportedFeatures);
+
+        //  GPU-driven drawing writes instance ranges into indirect commands and skips empty ones by a count
+        drawindirectfirstinstance_ = supportedFeatures.drawIndirectFirstInstance == VK_TRUE;
+        drawindirectcount_         = checkDeviceExtensionSupport(physdevice_, {VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME});
+
+        //  the GPU profiler counts primitives and shader invocations of its scopes where the device can
+        pipelinestatistics_        = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
+        //  compressed textures are used in whichever of the families the device has, see pickTextureFormats
+        texturecompressionbc_      = supportedFeatures.textureCompressionBC   == VK_TRUE;
+        texturecompressionetc2_    = supportedFeatures.textureCompressionETC2 == VK_TRUE;
+
+        std::vector<const char *> extensions = instance.get_extensions();
+        if (drawindirectcount_)
+            extensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+
         VkPhysicalDeviceFeatures  deviceFeatures{};
-        deviceFeatures.samplerAnisotropy = VK_TRUE;
+        deviceFeatures.samplerAnisotropy         =                                   VK_TRUE;
+        deviceFeatures.drawIndirectFirstInstance = drawindirectfirstinstance_ ? VK_TRUE : VK_FALSE;
+        deviceFeatures.pipelineStatisticsQuery   =        pipelinestatistics_ ? VK_TRUE : VK_FALSE;
+        deviceFeatures.textureCompressionBC      =      texturecompressionbc_ ? VK_TRUE : VK_FALSE;
+        deviceFeatures.textureCompressionETC2    =    texturecompressionetc2_ ? VK_TRUE : VK_FALSE;
+
+        //  checked in isDeviceSuitable, the bindless texture array needs all of them
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+        indexingFeatures.sType                                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+        indexingFeatures.runtimeDescriptorArray                       =                                                          VK_TRUE;
+        indexingFeatures.shaderSampledImageArrayNonUniformIndexing    =                                                          VK_TRUE;
+        indexingFeatures.descriptorBindingPartiallyBound              =                                                          VK_TRUE;
+        indexingFeatures.descriptorBindingSampledImageUpdateAfterBind =                                                          VK_TRUE;
 
         VkDeviceCreateInfo createInfo{};
         createInfo.sType                   =                       VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        createInfo.pNext                   =                                          &indexingFeatures;
         createInfo.queueCreateInfoCount    =             static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos       =                                    queueCreateInfos.data();
         createInfo.pEnabledFeatures        =                                            &deviceFeatures;
-        createInfo.enabledExtensionCount   =    static_cast<uint32_t>(instance.get_extensions().size());
-        createInfo.ppEnabledExtensionNames =                           instance.get_extensions().data();
+        createInfo.enabledExtensionCount   =                   static_cast<uint32_t>(extensions.size());
+        createInfo.ppEnabledExtensionNames =                                          extensions.data();
 
 
         if (instance.enabledebug())
@@ -45,5 +77,16 @@ namespace VKDevice
 
         vkGetDeviceQueue(logicdevice_, indices_.get_graphics_value(), 0, &graphics_queue_);
         vkGetDeviceQueue(logicdevice_,  indices_.get_present_value(), 0,  &present_queue_);
+        vkGetDeviceQueue(logicdevice_, indices_.get_transfer_value(), 0, &transfer_queue_);
+
+        if (drawindirectcount_)
+        {
+            cmddrawindirectcount_        = reinterpret_cast<PFN_vkCmdDrawIndirectCountKHR>
+                                           (vkGetDeviceProcAddr(logicdevice_, "vkCmdDrawIndirectCountKHR"));
+            cmddrawindexedindirectcount_ = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>
+                                           (vkGetDeviceProcAddr(logicdevice_, "vkCmdDrawIndexedIndirectCountKHR"));
+
+            drawindirectcount_ = cmddrawindirectcount_ != nullptr && cmddrawindexedindirectcount_ != nullptr;
+        }
     }
 }   //  end of VKDevice namespace
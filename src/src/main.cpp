@@ -1,11 +1,73 @@
 #include <iostream>
 #include <cstdlib>
+#include <map>
+#include <string>
+#include <cstring>
+#include <charconv>
 
 #include "app.hpp"
+#include "cpu_profiler.hpp"
+#include "alloc_counter.hpp"
 
-int main(int argv, char* argc[])
+namespace
 {
-    VKEngine::App app{};
+    //  the whole argument has to be a number of the type, so "abc", "12abc" or "-1" for a count are rejected
+    template <typename T>
+    bool parseNumber(const char* text, T& value)
+    {
+        const char* end = text + std::strlen(text);
+        auto [last, error] = std::from_chars(text, end, value);
+        return error == std::errc{} && last == end;
+    }
+}
+
+//  usage: app [--headless] [--frames N] [--capture file.ppm]
+//             [--present low-latency|immediate|vsync|adaptive] [--images N] [--fps N] [--profile file.json|file.csv]
+//             [--trace file.json] [--assert-no-alloc]
+int main(int argc, char* argv[])
+{
+    const std::map<std::string, VKSwapchain::PresentMode> presentModes {{"low-latency", VKSwapchain::PresentMode::LowLatency},
+                                                                        {"immediate",   VKSwapchain::PresentMode::Immediate},
+                                                                        {"vsync",       VKSwapchain::PresentMode::VSync},
+                                                                        {"adaptive",    VKSwapchain::PresentMode::AdaptiveVSync}};
+
+    VKEngine::Settings settings{};
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+
+        if (argument == "--headless")
+            settings.headless = true;
+        else if (argument == "--frames" && i + 1 < argc && parseNumber(argv[i + 1], settings.frames))
+            ++i;
+        else if (argument == "--capture" && i + 1 < argc)
+            settings.capturepath = argv[++i];
+        else if (argument == "--present" && i + 1 < argc && presentModes.count(argv[i + 1]))
+            settings.present.mode = presentModes.at(argv[++i]);
+        else if (argument == "--images" && i + 1 < argc && parseNumber(argv[i + 1], settings.present.imagecount))
+            ++i;
+        else if (argument == "--fps" && i + 1 < argc && parseNumber(argv[i + 1], settings.present.maxfps))
+            ++i;
+        else if (argument == "--profile" && i + 1 < argc)
+            settings.profilepath = argv[++i];
+        else if (argument == "--trace" && i + 1 < argc)
+            settings.tracepath = argv[++i];
+        else if (argument == "--assert-no-alloc")
+            settings.allocfree = true;
+        else
+        {
+            std::cerr << "unknown or malformed argument: " << argument << (i + 1 < argc ? std::string{" "} + argv[i + 1] : std::string{}) << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!settings.tracepath.empty() && !VKProfiler::CPU_PROFILING)
+        std::cerr << "CPU zones are compiled out, configure with -DCPU_PROFILING=ON to record them" << std::endl;
+    if (settings.allocfree && !VKAllocCounter::ALLOC_COUNTING)
+        std::cerr << "allocations are not counted, configure with -DALLOC_COUNTING=ON to check them" << std::endl;
+
+    VKEngine::App app{settings};
 
     try
     {
@@ -0,0 +1,156 @@
+#include "mesh_cache.hpp"
+
+#include "utility.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace VKMeshCache
+{
+
+    namespace
+    {
+        //  numbers the temporary files of this process, see write
+        std::atomic<uint64_t> tempcounter {0};
+
+        bool sourceStamp(const std::string& filepath, uint64_t& size, int64_t& time)
+        {
+            std::error_code error;
+            size = std::filesystem::file_size(filepath, error);
+            if (error)
+                return false;
+
+            time = std::filesystem::last_write_time(filepath, error).time_since_epoch().count();
+            return !error;
+        }
+    }
+
+    std::string cachePath(const std::string& filepath_to_model)
+    {
+        return filepath_to_model + ".vkmesh";
+    }
+
+    MappedMesh::~MappedMesh()
+    {
+        munmap(data_, size_);
+    }
+
+    std::unique_ptr<MappedMesh> MappedMesh::open(const std::string& cachepath, const std::string& filepath_to_model, uint32_t vertexsize)
+    {
+        int file = ::open(cachepath.c_str(), O_RDONLY);
+        if (file < 0)
+            return nullptr;
+
+        struct stat status;
+        if (fstat(file, &status) != 0 || static_cast<std::size_t>(status.st_size) < sizeof(MeshHeader))
+        {
+            close(file);
+            return nullptr;
+        }
+
+        std::size_t size = static_cast<std::size_t>(status.st_size);
+        void*       data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+
+        if (data == MAP_FAILED)
+            return nullptr;
+
+        std::unique_ptr<MappedMesh> mesh {new MappedMesh{data, size}};
+        const MeshHeader& header = mesh->header();
+
+        MeshHeader expected{};
+        if (std::memcmp(header.magic, expected.magic, sizeof(expected.magic)) != 0 || header.version != MESH_CACHE_VERSION ||
+            header.vertexsize != vertexsize)
+            return nullptr;
+
+        //  counts are checked by division first, a damaged header must not overflow the expected size
+        std::size_t payload = size - sizeof(MeshHeader);
+        if (header.vertexcount > payload / vertexsize)
+            return nullptr;
+
+        payload -= header.vertexcount * vertexsize;
+        if (header.indexcount > payload / sizeof(uint32_t) || payload != header.indexcount * sizeof(uint32_t))
+            return nullptr;
+
+        //  an unchanged stamp is trusted, otherwise the content decides (e.g. after a fresh checkout);
+        //  a missing source leaves the cache as the only copy of the mesh
+        uint64_t sourcesize = 0;
+        int64_t  sourcetime = 0;
+        if (!sourceStamp(filepath_to_model, sourcesize, sourcetime))
+            return mesh;
+
+        if (sourcesize == header.sourcesize && sourcetime == header.sourcetime)
+            return mesh;
+
+        if (sourcesize == header.sourcesize && Service::hashfile(filepath_to_model) == header.sourcehash)
+        {
+            //  the new stamp is stored so the next start trusts it again instead of hashing the source;
+            //  the mapping is private and only the stamp changes, a failed write merely costs another hash
+            int stampfile = ::open(cachepath.c_str(), O_WRONLY);
+            if (stampfile >= 0)
+            {
+                [[maybe_unused]] auto written = pwrite(stampfile, &sourcetime, sizeof(sourcetime), offsetof(MeshHeader, sourcetime));
+                close(stampfile);
+            }
+
+            return mesh;
+        }
+
+        return nullptr;
+    }
+
+    bool write(const std::string& cachepath, const std::string& filepath_to_model, uint32_t vertexsize,
+               const void* vertices, uint64_t vertexcount, const uint32_t* indices, uint64_t indexcount,
+               const glm::vec3& boundsmin, const glm::vec3& boundsmax)
+    {
+        MeshHeader header{};
+        header.vertexsize  =  vertexsize;
+        header.vertexcount = vertexcount;
+        header.indexcount  =  indexcount;
+        header.boundsmin   =   boundsmin;
+        header.boundsmax   =   boundsmax;
+
+        if (!sourceStamp(filepath_to_model, header.sourcesize, header.sourcetime))
+            return false;
+        header.sourcehash = Service::hashfile(filepath_to_model);
+
+        //  the same OBJ can be parsed by several tasks at once, for example with different textures, and by other processes;
+        //  every writer gets its own temporary file and the last rename wins, the contents are the same anyway
+        std::string temppath = cachepath + ".tmp." + std::to_string(getpid()) + "." + std::to_string(tempcounter.fetch_add(1));
+        std::error_code error;
+        {
+            std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return false;
+
+            file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+            file.write(static_cast<const char *>(vertices), static_cast<std::streamsize>(vertexcount * vertexsize));
+            file.write(reinterpret_cast<const char *>(indices), static_cast<std::streamsize>(indexcount * sizeof(uint32_t)));
+
+            if (!file)
+            {
+                file.close();
+                std::filesystem::remove(temppath, error);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temppath, cachepath, error);
+        if (error)
+        {
+            std::filesystem::remove(temppath, error);
+            return false;
+        }
+
+        return true;
+    }
+
+}   //  end of VKMeshCache namespace
@@ -1,6 +1,9 @@
 #include "model.hpp"
 
 #include "utility.hpp"
+#include "upload_context.hpp"
+#include "bindless.hpp"
+#include "ktx.hpp"
 
 #define TINYOBJLOADER_IMPOLEMENTATION
 #include "tinyobjloader.h"
@@ -8,32 +11,132 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
+#include <bit>
+#include <cmath>
 #include <cassert>
 #include <cstring>
+#include <algorithm>
 #include <iostream>
-#include <unordered_map>
 
-namespace std
+namespace VKModel
 {
 
-template<>
-struct hash<VKModel::Model::Vertex>
-{
-    size_t operator() (const VKModel::Model::Vertex& vertex) const
+    namespace
     {
-        size_t seed = 0;
-        Service::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-        return seed;
-    }
-};
+        //  below this amount of corners a chunk costs more in merging than it saves
+        constexpr std::size_t MIN_CORNERS_PER_CHUNK = 64 * 1024;
 
-}
+        Model::Vertex makeVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index)
+        {
+            Model::Vertex vertex{};
 
-namespace VKModel
-{
+            auto vertex_index = index.vertex_index;
+            if (vertex_index >= 0)
+            {
+                vertex.position = {
+                    attrib.vertices[3 * vertex_index + 0],
+                    attrib.vertices[3 * vertex_index + 1],
+                    attrib.vertices[3 * vertex_index + 2]
+                };
+
+                vertex.color = {
+                    attrib.colors[3 * vertex_index + 0],
+                    attrib.colors[3 * vertex_index + 1],
+                    attrib.colors[3 * vertex_index + 2]
+                };
+            }
+
+            auto normal_index = index.normal_index;
+            if (normal_index >= 0)
+            {
+                vertex.normal = {
+                    attrib.normals[3 * normal_index + 0],
+                    attrib.normals[3 * normal_index + 1],
+                    attrib.normals[3 * normal_index + 2]
+                };
+            }
+
+            auto texcoord_index = index.texcoord_index;
+            if (texcoord_index >= 0)
+            {
+                vertex.uv = {
+                    attrib.texcoords[2 * texcoord_index + 0],
+                    1.0f - attrib.texcoords[2 * texcoord_index + 1],
+                };
+            }
+
+            return vertex;
+        }
+
+        //  open addressing table of indices into a vertex array with linear probing; vertices are compared
+        //  bitwise, the same way they are hashed
+        class VertexTable final
+        {
+            static constexpr uint32_t EMPTY = UINT32_MAX;
+
+            std::vector<uint32_t> slots_;
+            std::size_t           mask_ = 0;
+
+            static std::size_t hash(const Model::Vertex& vertex)
+            {
+                uint32_t words[sizeof(Model::Vertex) / sizeof(uint32_t)];
+                std::memcpy(words, &vertex, sizeof(words));
+
+                uint64_t hash = 0x9e3779b97f4a7c15ull;
+                for (uint32_t word : words)
+                    hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+
+                return static_cast<std::size_t>(hash ^ (hash >> 32));
+            }
+
+            void place(uint32_t index, const Model::Vertex& vertex)
+            {
+                std::size_t slot = hash(vertex) & mask_;
+                while (slots_[slot] != EMPTY)
+                    slot = (slot + 1) & mask_;
+
+                slots_[slot] = index;
+            }
+
+            void grow(const std::vector<Model::Vertex>& vertices)
+            {
+                slots_.assign(slots_.size() * 2, EMPTY);
+                mask_ = slots_.size() - 1;
+
+                for (uint32_t index = 0; index < vertices.size(); ++index)
+                    place(index, vertices[index]);
+            }
+
+        public:
+
+            explicit VertexTable(std::size_t expected)
+            {
+                slots_.assign(std::bit_ceil(std::max<std::size_t>(expected * 2, 64)), EMPTY);
+                mask_ = slots_.size() - 1;
+            }
+
+            //  index of the vertex in vertices, it is appended there if it is seen for the first time
+            uint32_t insert(const Model::Vertex& vertex, std::vector<Model::Vertex>& vertices)
+            {
+                if ((vertices.size() + 1) * 2 > slots_.size())
+                    grow(vertices);
+
+                for (std::size_t slot = hash(vertex) & mask_;; slot = (slot + 1) & mask_)
+                {
+                    uint32_t index = slots_[slot];
+                    if (index == EMPTY)
+                    {
+                        slots_[slot] = static_cast<uint32_t>(vertices.size());
+                        vertices.push_back(vertex);
+                        return slots_[slot];
+                    }
+
+                    if (std::memcmp(&vertices[index], &vertex, sizeof(Model::Vertex)) == 0)
+                        return index;
+                }
+            }
+        };
+    }
 
     Model::Model (VKDevice::Device& device, const VKModel::Model::Builder& builder) : device_{device}
     {
@@ -42,18 +145,27 @@ namespace VKModel
             createTextureImage    (builder.filepath_to_texture);
             createTextureImageView();
             createTextureSampler  ();
+
+            textureindex_ = device_.get_textures().add(textureimgview_, texturesampler_);
         }
-        createVertexBuffer    (builder.vertices);
-        createIndexBuffer     (builder.indices);
+        createVertexBuffer    (builder.get_vertices());
+        createIndexBuffer     (builder.get_indices());
+
+        boundscenter_ = (builder.boundsmin + builder.boundsmax) * 0.5f;
+        boundsradius_ = glm::length(builder.boundsmax - builder.boundsmin) * 0.5f;
+
+        uploadticket_ = device_.get_uploader().pendingTicket();
     }
 
     Model::~Model()
     {
+        device_.get_textures().remove(textureindex_);
+
         vkDestroySampler  (device_.get_logic(), texturesampler_, nullptr);
         vkDestroyImageView(device_.get_logic(), textureimgview_, nullptr);
 
-        vkDestroyImage(device_.get_logic(),    textureimg_, nullptr);
-        vkFreeMemory  (device_.get_logic(), textureimgmem_, nullptr);
+        if (textureimg_ != VK_NULL_HANDLE)
+            device_.destroyImage(textureimg_, textureimgmem_);
     }
 
     std::unique_ptr<Model> Model::createModelfromFile (VKDevice::Device& device,const std::string& filepath_to_model, 
@@ -66,43 +178,170 @@ namespace VKModel
         return std::make_unique<Model> (device, builder);
     }
 
+    uint64_t Model::uploadTexture(const unsigned char* pixels, int width, int height)
+    {
+        assert(!has_texture() && "Model already has a texture");
+
+        createTextureImage    (pixels, width, height);
+        createTextureImageView();
+        createTextureSampler  ();
+
+        return device_.get_uploader().pendingTicket();
+    }
+
+    uint64_t Model::uploadTexture(const VKKtx::Texture& texture)
+    {
+        assert(!has_texture() && "Model already has a texture");
+
+        createTextureImage    (texture);
+        createTextureImageView();
+        createTextureSampler  ();
+
+        return device_.get_uploader().pendingTicket();
+    }
+
+    void Model::publishTexture()
+    {
+        assert(has_texture() && textureindex_ == VKBindless::FALLBACK_TEXTURE && "Texture was not uploaded or is published already");
+
+        textureindex_ = device_.get_textures().add(textureimgview_, texturesampler_);
+    }
+
     void Model::createTextureImage(const std::string& filepath)
     {
+        //  a compressed file next to the image is taken as it is, no decoding and no mip generation
+        auto compressed = VKKtx::findCompressed(filepath, device_.get_texture_formats());
+        if (!compressed.empty())
+        {
+            createTextureImage(VKKtx::read(compressed));
+            return;
+        }
+
         int texWidth, texHeight, texChannels;
-        stbi_uc* pixels        = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-        VkDeviceSize imagesize =                                                         texWidth * texHeight * 4;
+        stbi_uc* pixels = stbi_load(filepath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
         if (!pixels)
             throw std::runtime_error("failed to load texture image!");
 
-        VkBuffer stagingBuffer;
-        VkDeviceMemory stagingBufferMemory;
-        device_.createBuffer(imagesize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 
-                     stagingBuffer, stagingBufferMemory);
-        
-        void* mapping_data;
-        vkMapMemory(device_.get_logic(), stagingBufferMemory, 0, imagesize, 0, &mapping_data);
-        memcpy(mapping_data, pixels, static_cast<size_t>(imagesize));
-        vkUnmapMemory(device_.get_logic(), stagingBufferMemory);
+        createTextureImage(pixels, texWidth, texHeight);
 
         stbi_image_free(pixels);
+    }
+
+    void Model::createTextureImage(const unsigned char* pixels, int texWidth, int texHeight)
+    {
+        miplevels_ = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+
+        //  linear blits are the fast path, formats without linear filtering get the chain built on the CPU
+        VkFormatProperties formatProperties;
+        vkGetPhysicalDeviceFormatProperties(device_.get_phys(), VK_FORMAT_R8G8B8A8_SRGB, &formatProperties);
+
+        VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT |
+                                            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        bool linearBlit = (formatProperties.optimalTilingFeatures & blitFeatures) == blitFeatures;
+
+        device_.createImage (texWidth, texHeight, miplevels_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+                     VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                     textureimg_, textureimgmem_);
+
+        //  recorded into the current upload batch, the staging space is recycled once the batch is finished
+        auto& uploader = device_.get_uploader();
+        uploader.transitionImageLayout(textureimg_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, miplevels_);
 
-        device_.createImage (texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+        texturesize_ = 0;
+
+        if (linearBlit)
+        {
+            VkDeviceSize imagesize = static_cast<VkDeviceSize>(texWidth) * texHeight * 4;
+            VKUpload::Staging staging = uploader.stage(pixels, imagesize);
+
+            uploader.copyBufferToImage(staging.buffer, textureimg_, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight), staging.offset);
+            uploader.generateMipmaps(textureimg_, texWidth, texHeight, miplevels_);
+
+            int width = texWidth, height = texHeight;
+            for (uint32_t mip = 0; mip < miplevels_; ++mip)
+            {
+                texturesize_ += static_cast<VkDeviceSize>(width) * height * 4;
+
+                width  = std::max(width  / 2, 1);
+                height = std::max(height / 2, 1);
+            }
+        }
+        else
+        {
+            std::vector<stbi_uc> level (pixels, pixels + static_cast<std::size_t>(texWidth) * texHeight * 4);
+            std::vector<stbi_uc> next;
+
+            int width = texWidth, height = texHeight;
+            for (uint32_t mip = 0; mip < miplevels_; ++mip)
+            {
+                VKUpload::Staging staging = uploader.stage(level.data(), level.size());
+                uploader.copyBufferToImage(staging.buffer, textureimg_, static_cast<uint32_t>(width), static_cast<uint32_t>(height), staging.offset, mip);
+                texturesize_ += level.size();
+
+                if (mip + 1 < miplevels_)
+                {
+                    VKKtx::downsampleSRGB(level.data(), width, height, next);
+                    level.swap(next);
+
+                    width  = std::max(width  / 2, 1);
+                    height = std::max(height / 2, 1);
+                }
+            }
+
+            uploader.transitionImageLayout(textureimg_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, miplevels_);
+        }
+    }
+
+    void Model::createTextureImage(const VKKtx::Texture& texture)
+    {
+        if (!device_.supports_texture_format(texture.format))
+            throw std::runtime_error("failed to create texture image: compressed format is not supported by the device!");
+
+        textureformat_ = texture.format;
+        miplevels_     = static_cast<uint32_t>(texture.levels.size());
+
+        device_.createImage (texture.width, texture.height, miplevels_, textureformat_, VK_IMAGE_TILING_OPTIMAL,
                      VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                      textureimg_, textureimgmem_);
 
-        device_.transitionImageLayout(textureimg_, VK_FORMAT_R8G8B8A8_SRGB,            VK_IMAGE_LAYOUT_UNDEFINED,     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        device_.copyBufferToImage(stagingBuffer,               textureimg_,      static_cast<uint32_t>(texWidth),         static_cast<uint32_t>(texHeight));
-        device_.transitionImageLayout(textureimg_, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        auto& uploader = device_.get_uploader();
+        uploader.transitionImageLayout(textureimg_, textureformat_, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, miplevels_);
+
+        //  every level is in the file, the blocks are copied as they are; the ring offsets are multiples of the block size
+        texturesize_ = 0;
+        for (uint32_t mip = 0; mip < miplevels_; ++mip)
+        {
+            auto& level = texture.levels[mip];
+
+            VKUpload::Staging staging = uploader.stage(texture.data.data() + level.offset, level.size);
+            uploader.copyBufferToImage(staging.buffer, textureimg_, level.width, level.height, staging.offset, mip);
+            texturesize_ += level.size;
+        }
+
+        uploader.transitionImageLayout(textureimg_, textureformat_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, miplevels_);
+    }
+
+    bool Model::isReady() const
+    {
+        return device_.get_uploader().isComplete(uploadticket_);
+    }
+
+    VkDeviceSize Model::getMemorySize() const
+    {
+        VkDeviceSize size = texturesize_;
+
+        if (vertexbuff_)
+            size += vertexbuff_->getBufferSize();
+        if (indexbuff_)
+            size += indexbuff_->getBufferSize();
 
-        vkDestroyBuffer(device_.get_logic(), stagingBuffer, nullptr);
-        vkFreeMemory   (device_.get_logic(), stagingBufferMemory, nullptr);
+        return size;
     }
 
     void Model::createTextureImageView()
     {
-        textureimgview_ = device_.createImageView(textureimg_, VK_FORMAT_R8G8B8A8_SRGB);
+        textureimgview_ = device_.createImageView(textureimg_, textureformat_, miplevels_);
     }
 
     void Model::createTextureSampler()
@@ -124,12 +363,15 @@ namespace VKModel
         samplerInfo.compareEnable           =                               VK_FALSE;
         samplerInfo.compareOp               =                   VK_COMPARE_OP_ALWAYS;
         samplerInfo.mipmapMode              =          VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        samplerInfo.mipLodBias              =                                   0.0f;
+        samplerInfo.minLod                  =                                   0.0f;
+        samplerInfo.maxLod                  =          static_cast<float>(miplevels_);
 
         if (vkCreateSampler(device_.get_logic(), &samplerInfo, nullptr, &texturesampler_) != VK_SUCCESS)
             throw std::runtime_error("failed to create texture sampler!");
     }
 
-    void Model::createVertexBuffer(const std::vector<Vertex>& vertices)
+    void Model::createVertexBuffer(std::span<const Vertex> vertices)
     {
         vertexcount_ = static_cast<uint32_t>(vertices.size());
         assert(vertexcount_ >= 3 && "Vertex count must be at least 3\n");
@@ -137,21 +379,17 @@ namespace VKModel
         uint32_t vertexsize   = sizeof(vertices[0]);
         VkDeviceSize buffsize = vertexsize * vertexcount_;
 
-        //  creation of staging buffer in the GPU host
-        VKBuffmanager::Buffmanager stagingBuffer {device_, vertexsize, vertexcount_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void *) vertices.data());
+        //  vertices go through the persistent staging ring of the uploader
+        VKUpload::Staging staging = device_.get_uploader().stage(vertices.data(), buffsize);
 
         //  creation of buffer for the vertices on the GPU; device local and optimal memory
         vertexbuff_ = std::make_unique<VKBuffmanager::Buffmanager> (device_, vertexsize, vertexcount_, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                                                                     VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
         
-        device_.copyBuffer(stagingBuffer.getBuffer(), vertexbuff_->getBuffer(), buffsize);
+        device_.get_uploader().copyBuffer(staging.buffer, vertexbuff_->getBuffer(), buffsize, staging.offset);
     }
 
-    void Model::createIndexBuffer(const std::vector<uint32_t> &indices) 
+    void Model::createIndexBuffer(std::span<const uint32_t> indices) 
     {
         indexcount_    = static_cast<uint32_t>(indices.size());
         hasindexbuffer = indexcount_ > 0;
@@ -162,26 +400,40 @@ namespace VKModel
         uint32_t  indexsize   = sizeof(indices[0]);
         VkDeviceSize buffsize = sizeof(indices[0]) * indexcount_;
         
-        //  creation of staging buffer in the GPU host
-        VKBuffmanager::Buffmanager stagingBuffer {device_, indexsize, indexcount_, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, 
-                                                  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-
-        stagingBuffer.map();
-        stagingBuffer.writeToBuffer((void *) indices.data());
+        //  indices go through the persistent staging ring of the uploader
+        VKUpload::Staging staging = device_.get_uploader().stage(indices.data(), buffsize);
 
         //  creation of buffer for the indices on the GPU; device local and optimal memory
         indexbuff_ = std::make_unique<VKBuffmanager::Buffmanager> (device_, indexsize, indexcount_, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
                                                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
 
-        device_.copyBuffer(stagingBuffer.getBuffer(), indexbuff_->getBuffer(), buffsize);
+        device_.get_uploader().copyBuffer(staging.buffer, indexbuff_->getBuffer(), buffsize, staging.offset);
     }
 
-    void Model::draw(VkCommandBuffer commandbuffer)
+    void Model::draw(VkCommandBuffer commandbuffer, uint32_t instancecount, uint32_t firstinstance)
     {
         if (hasindexbuffer)
-            vkCmdDrawIndexed(commandbuffer, indexcount_, 1, 0, 0, 0);
+            vkCmdDrawIndexed(commandbuffer, indexcount_, instancecount, 0, 0, firstinstance);
         else
-            vkCmdDraw(commandbuffer, vertexcount_, 1, 0, 0);    //  put here some constants
+            vkCmdDraw(commandbuffer, vertexcount_, instancecount, 0, firstinstance);
+    }
+
+    void Model::drawIndirect(VkCommandBuffer commandbuffer, VkBuffer buffer, VkDeviceSize offset, VkBuffer countbuffer, VkDeviceSize countoffset)
+    {
+        if (hasindexbuffer)
+        {
+            if (device_.supports_indirect_count())
+                device_.cmdDrawIndexedIndirectCount(commandbuffer, buffer, offset, countbuffer, countoffset, 1, sizeof(VkDrawIndexedIndirectCommand));
+            else
+                vkCmdDrawIndexedIndirect(commandbuffer, buffer, offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+        }
+        else
+        {
+            if (device_.supports_indirect_count())
+                device_.cmdDrawIndirectCount(commandbuffer, buffer, offset, countbuffer, countoffset, 1, sizeof(VkDrawIndirectCommand));
+            else
+                vkCmdDrawIndirect(commandbuffer, buffer, offset, 1, sizeof(VkDrawIndirectCommand));
+        }
     }
 
     void Model::bind(VkCommandBuffer commandbuffer)
@@ -214,7 +466,51 @@ namespace VKModel
         return attributeDescriptions;
     }
 
-    void Model::Builder::load_models(const std::string& filepath_to_model)
+    std::span<const Model::Vertex> Model::Builder::get_vertices() const
+    {
+        if (mapping)
+            return {static_cast<const Vertex *>(mapping->vertices()), static_cast<std::size_t>(mapping->header().vertexcount)};
+        return vertices;
+    }
+
+    std::span<const uint32_t> Model::Builder::get_indices() const
+    {
+        if (mapping)
+            return {mapping->indices(), static_cast<std::size_t>(mapping->header().indexcount)};
+        return indices;
+    }
+
+    void Model::Builder::load_models(const std::string& filepath_to_model, VKThreadPool::ThreadPool* pool)
+    {
+        vertices.clear();
+        indices.clear();
+
+        //  warm start: the deduplicated mesh is mapped and goes to the staging ring without any parsing
+        std::string cachepath = VKMeshCache::cachePath(filepath_to_model);
+        if (auto cached = VKMeshCache::MappedMesh::open(cachepath, filepath_to_model, sizeof(Vertex)))
+        {
+            boundsmin = cached->header().boundsmin;
+            boundsmax = cached->header().boundsmax;
+            mapping   =           std::move(cached);
+            return;
+        }
+
+        mapping.reset();
+        parse_obj(filepath_to_model, pool);
+
+        boundsmin = boundsmax = vertices.empty() ? glm::vec3{0.0f} : vertices.front().position;
+        for (const auto& vertex : vertices)
+        {
+            boundsmin = glm::min(boundsmin, vertex.position);
+            boundsmax = glm::max(boundsmax, vertex.position);
+        }
+
+        //  a failed write only costs the next start another parse
+        VKMeshCache::write(cachepath, filepath_to_model, sizeof(Vertex), vertices.data(), vertices.size(),
+                           indices.data(), indices.size(), boundsmin, boundsmax);
+    }
+
+    void Model::Builder::parse_obj(const std::string& filepath_to_model, VKThreadPool::ThreadPool* pool)
     {
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
@@ -225,61 +521,72 @@ namespace VKModel
         if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, filepath_to_model.c_str()))
             throw std::runtime_error(warn + err);
 
-        vertices.clear();
-        indices.clear();
+        //  corners of all shapes in one range, split into chunks which are deduplicated independently
+        std::vector<tinyobj::index_t> corners;
+        for (const auto &shape : shapes)
+            corners.insert(corners.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
 
+        std::size_t chunkcount = 1;
+        if (pool != nullptr)
+            chunkcount = std::clamp<std::size_t>(corners.size() / MIN_CORNERS_PER_CHUNK, 1, pool->size() + 1);
 
-        std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-        for (const auto &shape : shapes)
+        std::size_t chunksize = (corners.size() + chunkcount - 1) / chunkcount;
+
+        struct Chunk
         {
-            for (const auto& index : shape.mesh.indices)
-            {
-                Vertex vertex{};
+            std::vector<Vertex>   vertices;
+            std::vector<uint32_t>  indices;
+        };
+        std::vector<Chunk> chunks (chunkcount);
 
-                auto vertex_index = index.vertex_index;
-                if (vertex_index >= 0)
-                {
-                    vertex.position = {
-                        attrib.vertices[3 * vertex_index + 0],
-                        attrib.vertices[3 * vertex_index + 1],
-                        attrib.vertices[3 * vertex_index + 2]
-                    };
-
-                    vertex.color = {
-                        attrib.colors[3 * vertex_index + 0],
-                        attrib.colors[3 * vertex_index + 1],
-                        attrib.colors[3 * vertex_index + 2]
-                    };
-                }
+        auto dedupChunk = [&](std::size_t chunkindex)
+        {
+            auto& chunk = chunks[chunkindex];
+            std::size_t first = chunkindex * chunksize;
+            std::size_t last  = std::min(first + chunksize, corners.size());
 
-                auto normal_index = index.normal_index;
-                if (normal_index >= 0)
-                {
-                    vertex.normal = {
-                        attrib.normals[3 * normal_index + 0],
-                        attrib.normals[3 * normal_index + 1],
-                        attrib.normals[3 * normal_index + 2]
-                    };
-                }
+            VertexTable table {(last - first) / 4};
+            chunk.indices.reserve(last - first);
 
-                auto texcoord_index = index.texcoord_index;
-                if (texcoord_index >= 0)
-                {
-                    vertex.uv = {
-                        attrib.texcoords[2 * texcoord_index + 0],
-                        1.0f - attrib.texcoords[2 * texcoord_index + 1],
-                    };
-                }
+            for (std::size_t corner = first; corner < last; ++corner)
+                chunk.indices.push_back(table.insert(makeVertex(attrib, corners[corner]), chunk.vertices));
+        };
 
+        if (pool != nullptr)
+            pool->parallel_for(chunkcount, dedupChunk);
+        else
+            dedupChunk(0);
 
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t> (vertices.size());
-                    vertices.push_back(vertex);
-                }
-                indices.push_back(uniqueVertices[vertex]);
-            }
+        if (chunkcount == 1)
+        {
+            vertices = std::move(chunks[0].vertices);
+            indices  = std::move(chunks[0].indices);
+            return;
+        }
+
+        //  merge: chunk-local unique vertices go through one global table in chunk order, which keeps the
+        //  first-occurrence order of a serial pass; the remapping of the indices runs in parallel again
+        VertexTable table {corners.size() / 4};
+        std::vector<std::vector<uint32_t>> remaps (chunkcount);
+
+        for (std::size_t chunkindex = 0; chunkindex < chunkcount; ++chunkindex)
+        {
+            auto& chunk = chunks[chunkindex];
+            remaps[chunkindex].reserve(chunk.vertices.size());
+
+            for (const auto& vertex : chunk.vertices)
+                remaps[chunkindex].push_back(table.insert(vertex, vertices));
         }
+
+        indices.resize(corners.size());
+        pool->parallel_for(chunkcount, [&](std::size_t chunkindex)
+        {
+            const auto& remap = remaps[chunkindex];
+            uint32_t*   out   = indices.data() + chunkindex * chunksize;
+
+            for (uint32_t local : chunks[chunkindex].indices)
+                *out++ = remap[local];
+        });
     }
 
 }   //  end of the VKModel namespace
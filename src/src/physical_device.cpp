@@ -1,6 +1,7 @@
 #include "instance.hpp"
 
 #include "swapchain.hpp"
+#include "bindless.hpp"
 
 #include <cstring>
 
@@ -32,8 +33,12 @@ namespace VKDevice
             if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT)
                 indices.graphics = index;
 
+            //  without a surface nothing is presented, the graphics queue stands in for the present one
             VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, index, instance.get_surface(), &presentSupport);
+            if (instance.enablepresent())
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, index, instance.get_surface(), &presentSupport);
+            else
+                presentSupport = (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
 
             if (presentSupport)
                 indices.present = index;
@@ -43,6 +48,21 @@ namespace VKDevice
 
             index++;
         }
+
+        //  copy engines work next to the graphics one; a family without graphics and compute is the best hint of them
+        indices.transfer.reset();
+        for (uint32_t family = 0; family < queue_families_count; ++family)
+        {
+            auto flags = queue_families[family].queueFlags;
+            if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT))
+                continue;
+
+            if (!(flags & VK_QUEUE_COMPUTE_BIT) || !indices.is_transfer())
+                indices.transfer = family;
+        }
+
+        if (!indices.is_transfer() && indices.is_graphics())
+            indices.transfer = indices.graphics;
     }
 
     bool checkDeviceExtensionSupport(VkPhysicalDevice device, 
@@ -62,24 +82,50 @@ namespace VKDevice
         return requiredExtensions.empty();
     }
 
+    //  textures are bound once as a runtime sized array indexed per instance
+    bool checkDescriptorIndexingSupport(VkPhysicalDevice device)
+    {
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(device, &properties);
+
+        if (properties.apiVersion < VK_API_VERSION_1_2)
+            return false;
+
+        VkPhysicalDeviceDescriptorIndexingFeatures indexingFeatures{};
+        indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext =                                &indexingFeatures;
+
+        vkGetPhysicalDeviceFeatures2(device, &features);
+
+        return indexingFeatures.runtimeDescriptorArray                        &&
+               indexingFeatures.shaderSampledImageArrayNonUniformIndexing     &&
+               indexingFeatures.descriptorBindingPartiallyBound               &&
+               indexingFeatures.descriptorBindingSampledImageUpdateAfterBind  &&
+               VKBindless::TextureArray::deviceCapacity(device) > VKBindless::FALLBACK_TEXTURE + 1;
+    }
+
     bool Device::isDeviceSuitable(VkPhysicalDevice device, VKInstance::Instance& instance)
     {
         findQueueFamilies(device, instance, indices_);
 
-        bool extensionsSupported = checkDeviceExtensionSupport(device, deviceExtensions_);
+        bool extensionsSupported = checkDeviceExtensionSupport(device, instance.get_extensions()) &&
+                                   checkDescriptorIndexingSupport(device);
+
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
         if (instance.enableswapchain())
         {
             VKSwapchain::SwapChainSupportDetails swapChainSupport = VKSwapchain::querySwapChainSupport(device, instance.get_surface());
             bool swapChainAdequate = indices_.is_present() && !swapChainSupport.formats_.empty() && !swapChainSupport.presentModes_.empty();
-        
-            VkPhysicalDeviceFeatures supportedFeatures;
-            vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
             return indices_.is_graphics() && indices_.is_present() && extensionsSupported && swapChainAdequate && supportedFeatures.samplerAnisotropy;
         }
 
-        return indices_.is_graphics() && extensionsSupported;
+        return indices_.is_graphics() && indices_.is_present() && extensionsSupported && supportedFeatures.samplerAnisotropy;
     }
 
     void Device::pickPhysicalDevice(VKInstance::Instance& instance)
@@ -105,7 +151,7 @@ namespace VKDevice
         if (physdevice_ == VK_NULL_HANDLE)
             throw std::runtime_error("failed to find a suitable GPU!");
 
-        // vkGetPhysicalDeviceProperties(physdevice_, &properties);  -  why does it not work?
+        vkGetPhysicalDeviceProperties(physdevice_, &properties_);
     }
 
 }   //  end of VKInstance namespace
@@ -6,7 +6,7 @@ namespace VKPipeline
 {
 
     Pipeline::Pipeline(VKDevice::Device& device, const PipelineConfigInfo& configInfo)
-                        : device_{device.get_logic()}
+                        : device_{device.get_logic()}, pipelinecache_{device.get_pipeline_cache()}
     {
         createGraphicsPipeline(configInfo);
     }
@@ -62,8 +62,8 @@ namespace VKPipeline
         VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
 
-        auto   binding_descriptions =   VKModel::Model::Vertex::get_binding_descriptions();
-        auto attribute_descriptions = VKModel::Model::Vertex::get_attribute_descriptions();
+        auto&   binding_descriptions =   configInfo.bindingDescriptions;
+        auto& attribute_descriptions = configInfo.attributeDescriptions;
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType                      = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
         vertexInputInfo.vertexBindingDescriptionCount   = static_cast<uint32_t>(  binding_descriptions.size());
@@ -146,7 +146,7 @@ namespace VKPipeline
         pipelineInfo.subpass             =                              configInfo.subpass;
         pipelineInfo.basePipelineHandle  =                                  VK_NULL_HANDLE;
 
-        if (vkCreateGraphicsPipelines(device_, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicspipeline_) != VK_SUCCESS)
+        if (vkCreateGraphicsPipelines(device_, pipelinecache_, 1, &pipelineInfo, nullptr, &graphicspipeline_) != VK_SUCCESS)
             throw std::runtime_error("failed to create graphics pipeline!");
     }
 
@@ -224,6 +224,9 @@ namespace VKPipeline
         configInfo.dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
         configInfo.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
         configInfo.dynamicStateInfo.flags = 0;
+
+        configInfo.bindingDescriptions   =   VKModel::Model::Vertex::get_binding_descriptions();
+        configInfo.attributeDescriptions = VKModel::Model::Vertex::get_attribute_descriptions();
     }
 
 }   //  end of VKPipeline namespace
@@ -0,0 +1,93 @@
+#include "device.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+
+namespace VKDevice
+{
+
+    namespace
+    {
+        //  layout of VkPipelineCacheHeaderVersionOne, which every cache blob starts with
+        constexpr std::size_t CACHE_HEADER_SIZE = 16 + VK_UUID_SIZE;
+
+        uint32_t readWord(const std::vector<char>& data, std::size_t offset)
+        {
+            uint32_t word;
+            std::memcpy(&word, data.data() + offset, sizeof(word));
+            return word;
+        }
+
+        //  a blob of another driver or GPU is not always rejected by the driver itself, so it is checked here
+        bool isPipelineCacheCompatible(const std::vector<char>& data, const VkPhysicalDeviceProperties& properties)
+        {
+            if (data.size() < CACHE_HEADER_SIZE)
+                return false;
+
+            uint32_t headersize    = readWord(data,  0);
+            uint32_t headerversion = readWord(data,  4);
+            uint32_t vendorid      = readWord(data,  8);
+            uint32_t deviceid      = readWord(data, 12);
+
+            return headersize    >=                    CACHE_HEADER_SIZE &&
+                   headerversion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                   vendorid      ==                  properties.vendorID &&
+                   deviceid      ==                  properties.deviceID &&
+                   std::memcmp(data.data() + 16, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+    }
+
+    void Device::createPipelineCache()
+    {
+        std::vector<char> data;
+
+        std::ifstream file(PIPELINE_CACHE_FILE_NAME, std::ios::ate | std::ios::binary);
+        if (file.is_open())
+        {
+            data.resize(static_cast<std::size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+            if (!file || !isPipelineCacheCompatible(data, properties_))
+                data.clear();
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo{};
+        cacheInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize =                                  data.size();
+        cacheInfo.pInitialData    =           data.empty() ? nullptr : data.data();
+
+        if (vkCreatePipelineCache(logicdevice_, &cacheInfo, nullptr, &pipelinecache_) != VK_SUCCESS)
+            throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    void Device::savePipelineCache()
+    {
+        std::size_t size = 0;
+        if (vkGetPipelineCacheData(logicdevice_, pipelinecache_, &size, nullptr) != VK_SUCCESS || size == 0)
+            return;
+
+        std::vector<char> data(size);
+        if (vkGetPipelineCacheData(logicdevice_, pipelinecache_, &size, data.data()) != VK_SUCCESS)
+            return;
+
+        //  written aside and renamed, so a crash while saving never leaves a torn cache behind
+        std::string temppath = PIPELINE_CACHE_FILE_NAME + ".tmp";
+        {
+            std::ofstream file(temppath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open())
+                return;
+
+            file.write(data.data(), static_cast<std::streamsize>(size));
+            if (!file)
+                return;
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temppath, PIPELINE_CACHE_FILE_NAME, error);
+        if (error)
+            std::filesystem::remove(temppath, error);
+    }
+
+}   //  end of VKDevice namespace
@@ -1,4 +1,6 @@
 #include "render_system.hpp"
+#include "bindless.hpp"
+#include "cpu_profiler.hpp"
 
 // libs
 #define GLM_FORCE_RADIANS
@@ -8,42 +10,129 @@
 
 // std
 #include <array>
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
+#include <filesystem>
 
 namespace VKRenderSystem {
 
-struct SimplePushConstantData 
-{
-    glm::mat4  modelMatrix{1.f};
-    glm::mat4 normalMatrix{1.f};
-};
+    namespace
+    {
+        constexpr uint32_t NO_RECORD = ~0u;
+        constexpr uint32_t NO_BATCH  = ~0u;
+
+        //  model to batch table with open addressing; it lives in the frame arena, so grouping objects allocates nothing
+        class BatchLookup
+        {
+            struct Slot
+            {
+                VKModel::Model* model = nullptr;
+                uint32_t        batch = NO_BATCH;
+            };
+
+            std::span<Slot> slots_;
+            std::size_t      mask_;
+
+            std::size_t slot(VKModel::Model* model) const
+            {
+                auto hash = reinterpret_cast<std::uintptr_t>(model) * 0x9E3779B97F4A7C15ull;
+                return (hash >> 32) & mask_;
+            }
+
+        public:
+
+            //  at most half full with capacity models, probes stay short
+            BatchLookup(VKFrameArena::FrameArena& arena, std::size_t capacity)
+            {
+                std::size_t size = 16;
+                while (size < capacity * 2)
+                    size *= 2;
+
+                slots_ = arena.allocate<Slot>(size);
+                mask_  =                   size - 1;
+            }
+
+            //  batch of model, which becomes next if the model had none
+            std::pair<uint32_t, bool> emplace(VKModel::Model* model, uint32_t next)
+            {
+                for (auto index = slot(model);; index = (index + 1) & mask_)
+                {
+                    if (slots_[index].model == model)
+                        return {slots_[index].batch, false};
+
+                    if (slots_[index].model == nullptr)
+                    {
+                        slots_[index] = {model, next};
+                        return {next, true};
+                    }
+                }
+            }
+
+            uint32_t find(VKModel::Model* model) const
+            {
+                for (auto index = slot(model); slots_[index].model != nullptr; index = (index + 1) & mask_)
+                    if (slots_[index].model == model)
+                        return slots_[index].batch;
+
+                return NO_BATCH;
+            }
+        };
+    }
+
+    std::vector<VkVertexInputBindingDescription> InstanceData::get_binding_descriptions()
+    {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+
+        bindingDescriptions.push_back({1, sizeof(InstanceData), VK_VERTEX_INPUT_RATE_INSTANCE});
+
+        return bindingDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> InstanceData::get_attribute_descriptions()
+    {
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+        //  every matrix takes four consecutive locations, one per column
+        for (uint32_t column = 0; column < 4; ++column)
+            attributeDescriptions.push_back({4 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT,
+                                             static_cast<uint32_t>(offsetof(InstanceData, modelMatrix) + column * sizeof(glm::vec4))});
+        for (uint32_t column = 0; column < 4; ++column)
+            attributeDescriptions.push_back({8 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT,
+                                             static_cast<uint32_t>(offsetof(InstanceData, normalMatrix) + column * sizeof(glm::vec4))});
+
+        attributeDescriptions.push_back({12, 1, VK_FORMAT_R32_UINT, static_cast<uint32_t>(offsetof(InstanceData, textureindex))});
+
+        return attributeDescriptions;
+    }
 
     RenderSystem::RenderSystem(VKDevice::Device &device, VkRenderPass renderPass, const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts): device_{device} 
     {
         createPipelineLayout(descriptorSetLayouts);
 
         createPipeline(renderPass);
+
+        gpuculling_ = device_.supports_indirect_first_instance() && std::filesystem::exists(VKPipeline::CULL_SHADER_FILE_NAME);
+        if (gpuculling_)
+            createCullPipeline();
     }
 
     RenderSystem::~RenderSystem() 
     {
         vkDestroyPipelineLayout(device_.get_logic(), pipelineLayout_, nullptr);
+
+        if (cullpipelinelayout_ != VK_NULL_HANDLE)
+            vkDestroyPipelineLayout(device_.get_logic(), cullpipelinelayout_, nullptr);
     }
 
     void RenderSystem::createPipelineLayout(const std::vector<VkDescriptorSetLayout>& descriptorSetLayouts) 
     {
-        VkPushConstantRange pushConstantRange{};
-        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-        pushConstantRange.offset = 0;
-        pushConstantRange.size = sizeof(SimplePushConstantData);
-
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType                  =      VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         pipelineLayoutInfo.setLayoutCount         = static_cast<uint32_t>(descriptorSetLayouts.size());
         pipelineLayoutInfo.pSetLayouts            =                        descriptorSetLayouts.data();
-        pipelineLayoutInfo.pushConstantRangeCount =                                                  1;
-        pipelineLayoutInfo.pPushConstantRanges    =                                 &pushConstantRange;
+        pipelineLayoutInfo.pushConstantRangeCount =                                                  0;
+        pipelineLayoutInfo.pPushConstantRanges    =                                            nullptr;
 
         if (vkCreatePipelineLayout(device_.get_logic(), &pipelineLayoutInfo, nullptr, &pipelineLayout_) !=
             VK_SUCCESS)
@@ -59,36 +148,429 @@ struct SimplePushConstantData
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout_;
 
+        auto instanceBindings   =   InstanceData::get_binding_descriptions();
+        auto instanceAttributes = InstanceData::get_attribute_descriptions();
+        pipelineConfig.bindingDescriptions.insert  (pipelineConfig.bindingDescriptions.end(),     instanceBindings.begin(),   instanceBindings.end());
+        pipelineConfig.attributeDescriptions.insert(pipelineConfig.attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
+
         pipeline_ = std::make_unique<VKPipeline::Pipeline>(device_, pipelineConfig);
     }
 
-    void RenderSystem::renderObjects(FrameInfo& frameinfo, std::vector<VKObject::Object> &objects)
+    void RenderSystem::createCullPipeline()
+    {
+        cullsetlayout_ = VKDescriptors::DescriptorSetLayout::Builder(device_).addBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                                                                            .addBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                                                                            .addBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+                                                                            .addBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT).build();
+
+        cullpool_ = VKDescriptors::DescriptorPool::Builder(device_).setMaxSets (VKSwapchain::MAX_FRAMES_IN_FLIGHT)
+                                                                   .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * VKSwapchain::MAX_FRAMES_IN_FLIGHT).build();
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset     =                           0;
+        pushConstantRange.size       =            sizeof(CullPush);
+
+        VkDescriptorSetLayout setLayout = cullsetlayout_->getDescriptorSetLayout();
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType                  = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount         =                                             1;
+        pipelineLayoutInfo.pSetLayouts            =                                    &setLayout;
+        pipelineLayoutInfo.pushConstantRangeCount =                                             1;
+        pipelineLayoutInfo.pPushConstantRanges    =                            &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device_.get_logic(), &pipelineLayoutInfo, nullptr, &cullpipelinelayout_) != VK_SUCCESS)
+            throw std::runtime_error("failed to create culling pipeline layout!");
+
+        cullpipeline_ = std::make_unique<VKPipeline::ComputePipeline>(device_, VKPipeline::CULL_SHADER_FILE_NAME, cullpipelinelayout_);
+    }
+
+    void RenderSystem::reserveCullFrame(int frameindex, uint32_t objectcount, uint32_t batchcount)
+    {
+        auto& frame = cullframes_[frameindex];
+        bool  grow  = !frame.objectbuff_ || frame.objectbuff_->getInstanceCount() < objectcount ||
+                                             frame.batchbuff_->getInstanceCount() <  batchcount;
+        if (!grow)
+            return;
+
+        auto capacity = [](const std::unique_ptr<VKBuffmanager::Buffmanager>& buff, uint32_t initial, uint32_t required)
+        {
+            uint32_t count = buff ? buff->getInstanceCount() : initial;
+            while (count < required)
+                count *= 2;
+            return count;
+        };
+        uint32_t objectcapacity = capacity(frame.objectbuff_, 64, objectcount);
+        uint32_t  batchcapacity = capacity(frame.batchbuff_,  16,  batchcount);
+
+        //  growing is rare, so it is cheaper to wait than to keep retired buffers around
+        if (frame.objectbuff_)
+            vkDeviceWaitIdle(device_.get_logic());
+
+        VkMemoryPropertyFlags hostmemory = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+        frame.objectbuff_   = std::make_unique<VKBuffmanager::Buffmanager> (device_, sizeof(CullObject), objectcapacity,
+                                                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, hostmemory);
+        frame.batchbuff_    = std::make_unique<VKBuffmanager::Buffmanager> (device_, sizeof(IndirectBatch), batchcapacity,
+                                                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, hostmemory);
+        frame.countbuff_    = std::make_unique<VKBuffmanager::Buffmanager> (device_, sizeof(uint32_t), batchcapacity,
+                                                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, hostmemory);
+        frame.instancebuff_ = std::make_unique<VKBuffmanager::Buffmanager> (device_, sizeof(InstanceData), objectcapacity,
+                                                                            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                                            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        frame.objectbuff_->map();
+        frame.batchbuff_->map();
+        frame.countbuff_->map();
+        frame.version_ = 0;   //  the new buffers start empty
+
+        auto objectInfo   =   frame.objectbuff_->descriptorInfo();
+        auto batchInfo    =    frame.batchbuff_->descriptorInfo();
+        auto countInfo    =    frame.countbuff_->descriptorInfo();
+        auto instanceInfo = frame.instancebuff_->descriptorInfo();
+
+        VKDescriptors::DescriptorWriter writer {*cullsetlayout_, *cullpool_};
+        writer.writeBuffer(0, &objectInfo).writeBuffer(1, &batchInfo).writeBuffer(2, &countInfo).writeBuffer(3, &instanceInfo);
+
+        if (frame.set_ == VK_NULL_HANDLE)
+        {
+            if (!writer.build(frame.set_))
+                throw std::runtime_error("failed to allocate culling descriptor set!");
+        }
+        else
+            writer.overwrite(frame.set_);
+    }
+
+    void RenderSystem::reserveInstances(int frameindex, uint32_t instancecount)
+    {
+        auto& instancebuff = instancebuffs_[frameindex];
+        if (instancebuff && instancebuff->getInstanceCount() >= instancecount)
+            return;
+
+        uint32_t capacity = instancebuff ? instancebuff->getInstanceCount() : 64;
+        while (capacity < instancecount)
+            capacity *= 2;
+
+        //  growing is rare, so it is cheaper to wait than to keep retired buffers around
+        if (instancebuff)
+            vkDeviceWaitIdle(device_.get_logic());
+
+        instancebuff = std::make_unique<VKBuffmanager::Buffmanager> (device_, sizeof(InstanceData), capacity, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                                                                     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        instancebuff->map();
+    }
+
+    void RenderSystem::cullObjects(FrameInfo& frameinfo, std::vector<VKObject::Object> &objects, const VKTransformSystem::TransformSystem& transforms)
+    {
+        if (gpuculling_)
+            cullOnGPU(frameinfo, objects, transforms);
+        else
+            cullOnCPU(frameinfo, objects, transforms);
+    }
+
+    void RenderSystem::cullOnCPU(FrameInfo& frameinfo, std::vector<VKObject::Object> &objects, const VKTransformSystem::TransformSystem& transforms)
+    {
+        //  bounds of every drawable object go to world space, then the frustum test runs over all of them in batches
+        spheres_.clear();
+
+        auto     candidates     = frameinfo.arena_.allocate<uint32_t>(objects.size());   //  object index of every sphere
+        uint32_t candidatecount = 0;
+
+        for (uint32_t object_index = 0; object_index < objects.size(); ++object_index)
+        {
+            auto& object = objects[object_index];
+            auto* model  =   object.model_.get();
+            if (model == nullptr || !model->isReady())   //  streamed models show up once their upload is done
+                continue;
+
+            const glm::mat4& matrix   =    transforms.getWorld(object.get_id());
+            float            maxscale = transforms.getMaxScale(object.get_id());
+
+            spheres_.push_back(glm::vec3{matrix * glm::vec4{model->getBoundsCenter(), 1.0f}}, model->getBoundsRadius() * maxscale);
+            candidates[candidatecount++] = object_index;
+        }
+
+        VKFrustum::cullSpheres(VKFrustum::Frustum{frameinfo.camera_.getProjection() * frameinfo.camera_.getView()}, spheres_, visible_);
+
+        //  grouping visible objects by model: counting pass, then every batch gets a contiguous range of instances
+        BatchLookup lookup  {frameinfo.arena_, candidatecount};
+        auto        batches = frameinfo.arena_.allocate<DrawBatch>(candidatecount);
+
+        uint32_t batchcount    = 0;
+        uint32_t instancecount = 0;
+        for (uint32_t candidate = 0; candidate < candidatecount; ++candidate)
+        {
+            if (!visible_[candidate])
+                continue;
+
+            uint32_t object_index = candidates[candidate];
+            auto*    model        = objects[object_index].model_.get();
+
+            auto [batch, inserted] = lookup.emplace(model, batchcount);
+            if (inserted)
+                batches[batchcount++] = DrawBatch{model, 0, 0};
+
+            batches[batch].instancecount_++;
+            instancecount++;
+        }
+
+        frameinfo.batches_ = batches.first(batchcount);
+        if (instancecount == 0)
+            return;
+
+        uint32_t firstinstance = 0;
+        for (auto& batch : frameinfo.batches_)
+        {
+            batch.firstinstance_ = firstinstance;
+            firstinstance       += batch.instancecount_;
+            batch.instancecount_ = 0;   //  reused as a write cursor below
+        }
+
+        reserveInstances(frameinfo.frameindex_, instancecount);
+        auto& instancebuff = instancebuffs_[frameinfo.frameindex_];
+        auto* instances    = static_cast<InstanceData *> (instancebuff->getMappedMemory());
+
+        for (uint32_t candidate = 0; candidate < candidatecount; ++candidate)
+        {
+            if (!visible_[candidate])
+                continue;
+
+            auto& object   = objects[candidates[candidate]];
+            auto& batch    = batches[lookup.find(object.model_.get())];
+            auto& instance = instances[batch.firstinstance_ + batch.instancecount_++];
+
+            instance.modelMatrix  =    transforms.getWorld(object.get_id());
+            instance.normalMatrix =   transforms.getNormal(object.get_id());
+            instance.textureindex =    object.model_->getTextureIndex();
+        }
+    }
+
+    bool RenderSystem::sceneChanged(const std::vector<VKObject::Object> &objects) const
+    {
+        if (objects.size() != scenemodels_.size())
+            return true;
+
+        for (std::size_t object_index = 0; object_index < objects.size(); ++object_index)
+            if (objects[object_index].model_.get() != scenemodels_[object_index] || objects[object_index].get_id() != sceneids_[object_index])
+                return true;
+
+        for (uint32_t object_index : waiting_)
+            if (objects[object_index].model_->isReady())
+                return true;
+
+        return false;
+    }
+
+    void RenderSystem::rebuildScene(VKFrameArena::FrameArena& arena, const std::vector<VKObject::Object> &objects, const VKTransformSystem::TransformSystem& transforms)
+    {
+        scenebatches_.clear();
+        scenemodels_.clear();
+        sceneids_.clear();
+        sceneobjects_.clear();
+        recordbatch_.clear();
+        waiting_.clear();
+        recordofid_.assign(transforms.size(), NO_RECORD);
+
+        //  every batch reserves an instance range big enough for all of its objects
+        BatchLookup lookup {arena, objects.size()};
+        for (uint32_t object_index = 0; object_index < objects.size(); ++object_index)
+        {
+            auto& object = objects[object_index];
+            auto* model  =   object.model_.get();
+            scenemodels_.push_back(model);
+            sceneids_.push_back(object.get_id());
+
+            if (model == nullptr)
+                continue;
+
+            if (!model->isReady())
+            {
+                waiting_.push_back(object_index);
+                continue;
+            }
+
+            auto [batch, inserted] = lookup.emplace(model, static_cast<uint32_t>(scenebatches_.size()));
+            if (inserted)
+                scenebatches_.push_back(DrawBatch{model, 0, 0});
+
+            scenebatches_[batch].instancecount_++;
+
+            recordofid_[object.get_id()] = static_cast<uint32_t>(sceneobjects_.size());
+            sceneobjects_.push_back(object_index);
+            recordbatch_.push_back(batch);
+        }
+
+        uint32_t firstinstance = 0;
+        for (auto& batch : scenebatches_)
+        {
+            batch.firstinstance_ = firstinstance;
+            firstinstance       += batch.instancecount_;
+        }
+
+        //  every frame in flight rewrites all of its records once
+        for (auto& frame : cullframes_)
+        {
+            frame.pending_.clear();
+            frame.marked_.assign(recordofid_.size(), 0);
+        }
+
+        sceneversion_++;
+    }
+
+    void RenderSystem::writeRecord(CullObject& record, const VKObject::Object& object, uint32_t batch, const VKTransformSystem::TransformSystem& transforms)
+    {
+        float maxscale = transforms.getMaxScale(object.get_id());
+
+        record.modelMatrix  =                    transforms.getWorld(object.get_id());
+        record.normalMatrix =                   transforms.getNormal(object.get_id());
+        record.bounds       = glm::vec4{object.model_->getBoundsCenter(), object.model_->getBoundsRadius() * maxscale};
+        record.batch        =                                                  batch;
+    }
+
+    void RenderSystem::cullOnGPU(FrameInfo& frameinfo, std::vector<VKObject::Object> &objects, const VKTransformSystem::TransformSystem& transforms)
     {
-        pipeline_->bind(frameinfo.commandbuffer_);
+        //  the CPU only keeps the objects grouped by model and mirrors the matrices of moved ones, the shader does the rest
+        if (sceneChanged(objects))
+            rebuildScene(frameinfo.arena_, objects, transforms);
+
+        frameinfo.batches_ = scenebatches_;
+
+        auto recordcount = static_cast<uint32_t>(sceneobjects_.size());
+        auto  batchcount = static_cast<uint32_t>(scenebatches_.size());
+        if (recordcount == 0)
+            return;
+
+        //  records of moved objects are stale in every frame in flight, each one catches up when it is recorded next
+        for (uint32_t id : transforms.getUpdated())
+        {
+            if (id >= recordofid_.size() || recordofid_[id] == NO_RECORD)
+                continue;
+
+            for (auto& frame : cullframes_)
+                if (!frame.marked_[id])
+                {
+                    frame.marked_[id] = 1;
+                    frame.pending_.push_back(id);
+                }
+        }
+
+        reserveCullFrame(frameinfo.frameindex_, recordcount, batchcount);
+        auto& frame = cullframes_[frameinfo.frameindex_];
+
+        auto* records = static_cast<CullObject *>(frame.objectbuff_->getMappedMemory());
+        if (frame.version_ != sceneversion_)
+        {
+            for (uint32_t record = 0; record < recordcount; ++record)
+                writeRecord(records[record], objects[sceneobjects_[record]], recordbatch_[record], transforms);
+
+            frame.version_ = sceneversion_;
+        }
+        else
+            for (uint32_t id : frame.pending_)
+            {
+                uint32_t record = recordofid_[id];
+                writeRecord(records[record], objects[sceneobjects_[record]], recordbatch_[record], transforms);
+            }
+
+        for (uint32_t id : frame.pending_)
+            frame.marked_[id] = 0;
+        frame.pending_.clear();
+
+        //  instance counts start at zero and are accumulated by the shader; everything shared by a model lives in its command
+        auto* commands = static_cast<IndirectBatch *>(frame.batchbuff_->getMappedMemory());
+        auto* counts   = static_cast<uint32_t *>     (frame.countbuff_->getMappedMemory());
+        for (uint32_t index = 0; index < batchcount; ++index)
+        {
+            auto& batch   = scenebatches_[index];
+            auto& command =      commands[index];
+
+            command = IndirectBatch{};
+            if (batch.model_->hasIndices())
+                command.command.indexed = VkDrawIndexedIndirectCommand{batch.model_->getIndexCount(), 0, 0, 0, batch.firstinstance_};
+            else
+                command.command.plain   = VkDrawIndirectCommand{batch.model_->getVertexCount(), 0, 0, batch.firstinstance_};
+            command.base         =              batch.firstinstance_;
+            command.textureindex = batch.model_->getTextureIndex();
+            counts[index]        =                                 0;
+        }
 
+        CullPush push{};
+        VKFrustum::Frustum frustum {frameinfo.camera_.getProjection() * frameinfo.camera_.getView()};
+        for (std::size_t plane = 0; plane < frustum.get_planes().size(); ++plane)
+            push.planes[plane] = frustum.get_planes()[plane];
+        push.objectcount = recordcount;
 
-        vkCmdBindDescriptorSets(frameinfo.commandbuffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                                pipelineLayout_, 0, 1, &frameinfo.globaldescriptorsets_[0], 0, nullptr);
+        cullpipeline_->bind(frameinfo.commandbuffer_);
+        vkCmdBindDescriptorSets(frameinfo.commandbuffer_, VK_PIPELINE_BIND_POINT_COMPUTE, cullpipelinelayout_, 0, 1, &frame.set_, 0, nullptr);
+        vkCmdPushConstants(frameinfo.commandbuffer_, cullpipelinelayout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(push), &push);
+        vkCmdDispatch(frameinfo.commandbuffer_, (recordcount + 63) / 64, 1, 1);
 
-        //  1) Вынести связывание текстур, засунутых в отдельный массив.
-        //  2) Отсечение по видимости. 
+        //  commands, counts and instances are consumed by the draws of this frame
+        VkMemoryBarrier barrier{};
+        barrier.sType         =                                             VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+        barrier.srcAccessMask =                                                  VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
 
-        for (int object_index = 0; object_index < objects.size(); ++object_index)
+        vkCmdPipelineBarrier(frameinfo.commandbuffer_, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                             VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+    }
+
+    uint32_t RenderSystem::recorderCount(const FrameInfo& frameinfo, std::size_t threadcount) const
+    {
+        auto batchcount = static_cast<uint32_t>(frameinfo.batches_.size());
+        return static_cast<uint32_t>(std::min<std::size_t>(threadcount, batchcount / MIN_BATCHES_PER_RECORDER));
+    }
+
+    void RenderSystem::renderObjects(FrameInfo& frameinfo)
+    {
+        recordBatches(frameinfo.commandbuffer_, frameinfo, 0, static_cast<uint32_t>(frameinfo.batches_.size()));
+    }
+
+    void RenderSystem::renderObjects(FrameInfo& frameinfo, const std::vector<VkCommandBuffer>& secondaries, VKThreadPool::ThreadPool& pool)
+    {
+        auto batchcount    = static_cast<uint32_t>(frameinfo.batches_.size());
+        auto recordercount = static_cast<uint32_t>(secondaries.size());
+
+        pool.parallel_for(recordercount, [&](std::size_t recorder)
         {
-            SimplePushConstantData                                         push_data{};
+            uint32_t firstbatch = static_cast<uint32_t>( recorder      * batchcount / recordercount);
+            uint32_t  lastbatch = static_cast<uint32_t>((recorder + 1) * batchcount / recordercount);
 
-            push_data.modelMatrix    =       objects[object_index].transform3D_.mat4();
-            push_data.normalMatrix = objects[object_index].transform3D_.normalMatrix();
+            recordBatches(secondaries[recorder], frameinfo, firstbatch, lastbatch);
+        });
+    }
+
+    void RenderSystem::recordBatches(VkCommandBuffer commandbuffer, const FrameInfo& frameinfo, uint32_t firstbatch, uint32_t lastbatch)
+    {
+        if (firstbatch >= lastbatch)
+            return;
+
+        VK_CPU_ZONE("record batches");
+
+        pipeline_->bind(commandbuffer);
 
-            vkCmdPushConstants (frameinfo.commandbuffer_, pipelineLayout_, 
-                                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                                0, sizeof(SimplePushConstantData), &push_data);
+        auto& frame = cullframes_[frameinfo.frameindex_];
+
+        VkBuffer     buffers[] = {gpuculling_ ? frame.instancebuff_->getBuffer() : instancebuffs_[frameinfo.frameindex_]->getBuffer()};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandbuffer, 1, 1, buffers, offsets);
+
+        //  global uniforms and the bindless textures are bound once, instances pick their texture by index
+        vkCmdBindDescriptorSets(commandbuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout_, 0,
+                                static_cast<uint32_t>(frameinfo.descriptorsets_.size()), frameinfo.descriptorsets_.data(),
+                                static_cast<uint32_t>(frameinfo.dynamicoffsets_.size()), frameinfo.dynamicoffsets_.data());
+
+        for (uint32_t index = firstbatch; index < lastbatch; ++index)
+        {
+            auto& batch = frameinfo.batches_[index];
 
-            vkCmdBindDescriptorSets(frameinfo.commandbuffer_, VK_PIPELINE_BIND_POINT_GRAPHICS, 
-                                pipelineLayout_, 0, 1, &frameinfo.globaldescriptorsets_[object_index], 0, nullptr);
+            batch.model_ -> bind(commandbuffer);
 
-            objects[object_index].model_ -> bind(frameinfo.commandbuffer_);
-            objects[object_index].model_ -> draw(frameinfo.commandbuffer_);
+            if (gpuculling_)
+                batch.model_ -> drawIndirect(commandbuffer, frame.batchbuff_->getBuffer(), index * sizeof(IndirectBatch),
+                                                            frame.countbuff_->getBuffer(), index * sizeof(uint32_t));
+            else
+                batch.model_ -> draw(commandbuffer, batch.instancecount_, batch.firstinstance_);
         }
     }
 
@@ -1,17 +1,37 @@
 #include "renderer.hpp"
+#include "upload_context.hpp"
+#include "cpu_profiler.hpp"
+
+#include <thread>
+#include <algorithm>
 
 namespace VKRenderer
 {
-    Renderer::Renderer (VKWindow::Window& window, VKDevice::Device& device) : 
-                        window_{window}, device_{device}
+    Renderer::Renderer (VKWindow::Window& window, VKDevice::Device& device, const VKSwapchain::PresentPolicy& policy) : 
+                        window_{window}, device_{device}, policy_{policy}, profiler_{device}, nextframe_{std::chrono::steady_clock::now()}
     {
-        swapchain_ = std::make_unique<VKSwapchain::Swapchain>(window_, device_);
+        swapchain_ = std::make_unique<VKSwapchain::Swapchain>(window_, device_, policy_);
         recreateSwapChain();
 
         createCommandBuffers();
     }
 
-    Renderer::~Renderer () { freeCommandBuffers(); }
+    Renderer::~Renderer () 
+    { 
+        freeCommandBuffers(); 
+        destroyRecorders();
+    }
+
+    void Renderer::destroyRecorders()
+    {
+        //  destroying a pool frees its command buffers as well
+        for (auto& recorders : recorders_)
+        {
+            for (auto& recorder : recorders)
+                vkDestroyCommandPool(device_.get_logic(), recorder.commandpool_, nullptr);
+            recorders.clear();
+        }
+    }
 
     void Renderer::freeCommandBuffers()
     {
@@ -25,15 +45,51 @@ namespace VKRenderer
         auto extent = window_.get_extent();
         while (extent.width == 0 || extent.height == 0)
         {
-            auto extent = window_.get_extent();
+            extent = window_.get_extent();
             glfwWaitEvents();
         }
         vkDeviceWaitIdle(device_.get_logic());
 
         if (swapchain_->get_swapchain() == nullptr)
-            swapchain_ = std::make_unique<VKSwapchain::Swapchain>(window_, device_);
+            swapchain_ = std::make_unique<VKSwapchain::Swapchain>(window_, device_, policy_);
         else
-            swapchain_ = std::make_unique<VKSwapchain::Swapchain>(window_, device_, std::move(swapchain_));
+            swapchain_ = std::make_unique<VKSwapchain::Swapchain>(window_, device_, std::move(swapchain_), policy_);
+    }
+
+    void Renderer::setPresentPolicy(const VKSwapchain::PresentPolicy& policy)
+    {
+        assert(!isFrameStarted_ && "Can't change present policy while frame is in progress");
+
+        bool recreate = policy.mode != policy_.mode || policy.imagecount != policy_.imagecount;
+
+        policy_    =                            policy;
+        nextframe_ = std::chrono::steady_clock::now();
+
+        //  offscreen frames are never presented, the policy has nothing to change there
+        if (recreate && !swapchain_->is_offscreen())
+            recreateSwapChain();
+    }
+
+    void Renderer::paceFrame()
+    {
+        if (policy_.maxfps <= 0.0f)
+            return;
+
+        using clock = std::chrono::steady_clock;
+
+        auto period = std::chrono::duration_cast<clock::duration>(std::chrono::duration<float>(1.0f / policy_.maxfps));
+        auto now    =                                                                                      clock::now();
+
+        if (now < nextframe_)
+        {
+            //  sleeping wakes up late by up to a scheduler tick, so the last millisecond is yielded away instead
+            std::this_thread::sleep_until(nextframe_ - std::chrono::milliseconds(1));
+            while (clock::now() < nextframe_)
+                std::this_thread::yield();
+        }
+
+        //  a late frame starts a new schedule instead of making the following ones rush to catch up
+        nextframe_ = std::max(nextframe_, now) + period;
 
     }
 
@@ -54,6 +110,21 @@ namespace VKRenderer
     VkCommandBuffer Renderer::beginFrame()
     {
         assert(!isFrameStarted_ && "Can't call beginFrame while rendering is processing");
+
+        {
+            VK_CPU_ZONE("pace");
+            paceFrame();
+        }
+
+        //  uploads recorded since the previous frame go to the queue ahead of this frame's commands
+        {
+            VK_CPU_ZONE("upload submit");
+            device_.get_uploader().submit();
+        }
+
+        //  resources of a frame in flight are free once the acquire waited for its fence; the image index may be anything
+        currentFrameIndex_ = static_cast<uint32_t>(swapchain_->get_index_currentframe());
+
         auto result = swapchain_->acquireNextImage(&currentImageIndex_);
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
@@ -66,6 +137,12 @@ namespace VKRenderer
 
         isFrameStarted_ = true;
 
+        //  the fence of this frame was waited for by the acquire, nothing recorded from its pools is pending anymore
+        for (auto& recorder : recorders_[currentFrameIndex_])
+            vkResetCommandPool(device_.get_logic(), recorder.commandpool_, 0);
+        secondaries_.clear();
+        arenas_[currentFrameIndex_].reset();
+
         auto commandBuffer = get_currentcmdbuffer();
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -73,6 +150,10 @@ namespace VKRenderer
         if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
             throw std::runtime_error("failed to begin recording command buffer!");
 
+        //  queries of this frame slot were last written two frames ago and are complete after the fence wait
+        profiler_.beginFrame(commandBuffer, currentFrameIndex_);
+        framescope_ = profiler_.beginScope(commandBuffer, "frame");
+
         return commandBuffer;
     }
 
@@ -81,6 +162,8 @@ namespace VKRenderer
         assert(isFrameStarted_ && "Can't call endFrame while frame is not in progress");
 
         auto commandBuffer = get_currentcmdbuffer();
+        profiler_.endScope(commandBuffer, framescope_);
+
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
             throw std::runtime_error("failed to record command buffer!");
 
@@ -95,10 +178,10 @@ namespace VKRenderer
             throw std::runtime_error("failed to present swapchain image");
 
         isFrameStarted_ = false;
-        currentImageIndex_ = (currentImageIndex_ + 1) % VKSwapchain::MAX_FRAMES_IN_FLIGHT;
+        lastImageIndex_ = currentImageIndex_;
     }
 
-    void Renderer::beginSwapchainRenderpass(VkCommandBuffer commandBuffer)
+    void Renderer::beginSwapchainRenderpass(VkCommandBuffer commandBuffer, VkSubpassContents contents)
     {
         assert(isFrameStarted_ && "Can't call beginSwapChainRenderPass if frame is not in progress");
         assert(commandBuffer == get_currentcmdbuffer() && "Can't begining renderpass from different frames");
@@ -118,7 +201,14 @@ namespace VKRenderer
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues    =                        clearValues.data();
 
-        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+        //  a statistics query active around secondaries would need inherited queries, so those passes get timestamps only
+        renderpassscope_ = profiler_.beginScope(commandBuffer, "renderpass", contents == VK_SUBPASS_CONTENTS_INLINE);
+
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+
+        //  dynamic state is not inherited, every secondary sets its own
+        if (contents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS)
+            return;
 
         VkViewport viewport{};
         viewport.x        =                            0.0f;
@@ -141,6 +231,95 @@ namespace VKRenderer
         assert(commandBuffer == get_currentcmdbuffer() && "Can't end renderpass from different frames");
 
         vkCmdEndRenderPass(commandBuffer);
+        profiler_.endScope(commandBuffer, renderpassscope_);
+    }
+
+    const std::vector<VkCommandBuffer>& Renderer::beginSecondaryCommandBuffers(uint32_t count)
+    {
+        assert(isFrameStarted_ && "Can't begin secondary command buffers if frame is not in progress");
+        assert(secondaries_.empty() && "Secondary command buffers were already begun in this frame");
+
+        auto& recorders = recorders_[currentFrameIndex_];
+        while (recorders.size() < count)
+        {
+            Recorder recorder{};
+
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags            =       VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = device_.get_indices().get_graphics_value();
+
+            if (vkCreateCommandPool(device_.get_logic(), &poolInfo, nullptr, &recorder.commandpool_) != VK_SUCCESS)
+                throw std::runtime_error("failed to create secondary command pool!");
+
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool        =                         recorder.commandpool_;
+            allocInfo.level              =              VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount =                                             1;
+
+            if (vkAllocateCommandBuffers(device_.get_logic(), &allocInfo, &recorder.commandbuffer_) != VK_SUCCESS)
+            {
+                vkDestroyCommandPool(device_.get_logic(), recorder.commandpool_, nullptr);
+                throw std::runtime_error("failed to allocate secondary command buffer!");
+            }
+
+            recorders.push_back(recorder);
+        }
+
+        VkCommandBufferInheritanceInfo inheritanceInfo{};
+        inheritanceInfo.sType       =      VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+        inheritanceInfo.renderPass  =                           swapchain_->get_renderpass();
+        inheritanceInfo.subpass     =                                                      0;
+        inheritanceInfo.framebuffer =        swapchain_->get_framebuffer(currentImageIndex_);
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType            =                          VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags            = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        beginInfo.pInheritanceInfo =                                                      &inheritanceInfo;
+
+        auto swapchain_extent = swapchain_->get_extent();
+
+        VkViewport viewport{};
+        viewport.x        =                            0.0f;
+        viewport.y        =                            0.0f;
+        viewport.width    = (float)  swapchain_extent.width;
+        viewport.height   = (float) swapchain_extent.height;
+        viewport.minDepth =                            0.0f;
+        viewport.maxDepth =                            1.0f;
+
+        VkRect2D scissor{};
+        scissor.offset =           {0, 0};
+        scissor.extent = swapchain_extent;
+
+        for (uint32_t index = 0; index < count; ++index)
+        {
+            auto commandBuffer = recorders[index].commandbuffer_;
+            if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+                throw std::runtime_error("failed to begin recording secondary command buffer!");
+
+            vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+            vkCmdSetScissor (commandBuffer, 0, 1,  &scissor);
+
+            secondaries_.push_back(commandBuffer);
+        }
+
+        return secondaries_;
+    }
+
+    void Renderer::executeSecondaryCommandBuffers(VkCommandBuffer commandBuffer)
+    {
+        assert(isFrameStarted_ && "Can't execute secondary command buffers if frame is not in progress");
+        assert(commandBuffer == get_currentcmdbuffer() && "Can't execute secondary command buffers from different frames");
+
+        if (secondaries_.empty())
+            return;
+
+        for (auto secondary : secondaries_)
+            if (vkEndCommandBuffer(secondary) != VK_SUCCESS)
+                throw std::runtime_error("failed to record secondary command buffer!");
+
+        vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaries_.size()), secondaries_.data());
     }
 
 }
@@ -14,7 +14,7 @@ namespace VKSwapchain
         colorAttachment.stencilLoadOp  =  VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.initialLayout  =        VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout    =  VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        colorAttachment.finalLayout    =  is_offscreen() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentDescription depthAttachment{};
         depthAttachment.format         =              findDepthFormat(device_.get_phys());
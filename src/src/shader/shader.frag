@@ -1,19 +1,16 @@
 #version 450
 
-//  const int MAX_TEXTURES = 16;
+#extension GL_EXT_nonuniform_qualifier : require
 
 layout(location = 0) in vec3    fragColor;
 layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragTextureIndex;
 
 layout(location = 0) out vec4 outColor;
 
-layout(binding = 1) uniform sampler2D texSampler;
-
-layout(push_constant) uniform Push {
-    mat4  modelMatrix;
-    mat4 normalMatrix;
-} push;
+//  every texture of the scene, untextured models read the white texel of element 0
+layout(set = 1, binding = 0) uniform sampler2D textures[];
 
 void main() {
-    outColor = vec4(fragColor, 1.0) * texture(texSampler, fragTexCoord);
+    outColor = vec4(fragColor, 1.0) * texture(textures[nonuniformEXT(fragTextureIndex)], fragTexCoord);
 }
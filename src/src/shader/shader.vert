@@ -5,9 +5,15 @@ layout(location = 1) in  vec3     color;
 layout(location = 2) in  vec3    normal;
 layout(location = 3) in  vec2        uv;
 
+//  per-instance attributes, every matrix occupies four locations
+layout(location = 4) in  mat4  modelMatrix;
+layout(location = 8) in  mat4 normalMatrix;
+layout(location = 12) in uint textureIndex;
+
 
 layout(location = 0) out vec3    fragColor;
 layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragTextureIndex;
 
 
 layout(set = 0, binding = 0) uniform GlobalUbo {
@@ -15,20 +21,16 @@ layout(set = 0, binding = 0) uniform GlobalUbo {
     vec3     directionToLight;
 } ubo;
 
-layout(push_constant) uniform Push {
-    mat4  modelMatrix;
-    mat4 normalMatrix;
-} push;
-
 const float AMBIENT = 0.02;
 
 void main() {
-    gl_Position = ubo.projectionViewMatrix * push.modelMatrix * vec4(position, 1.0);     //  homogeneous coordinate
+    gl_Position = ubo.projectionViewMatrix * modelMatrix * vec4(position, 1.0);     //  homogeneous coordinate
 
-    vec3 normalWorldSpace = normalize(mat3(push.normalMatrix) * normal);
+    vec3 normalWorldSpace = normalize(mat3(normalMatrix) * normal);
 
     float lightIntensity  = AMBIENT + max(dot (normalWorldSpace, ubo.directionToLight), 0);
 
-    fragColor    = lightIntensity * color;
-    fragTexCoord =                     uv;
+    fragColor        = lightIntensity * color;
+    fragTexCoord     =                     uv;
+    fragTextureIndex =           textureIndex;
 }
@@ -1,6 +1,7 @@
 #include "swapchain.hpp"
 
 #include "model.hpp"
+#include "cpu_profiler.hpp"
 
 #include <limits>
 #include <algorithm>
@@ -8,8 +9,8 @@
 namespace VKSwapchain
 {
 
-    Swapchain::Swapchain(VKWindow::Window& window, VKDevice::Device& device) : 
-                         device_{device}, surface_{device.get_surface()}
+    Swapchain::Swapchain(VKWindow::Window& window, VKDevice::Device& device, const PresentPolicy& policy) : 
+                         device_{device}, surface_{device.get_surface()}, policy_{policy}
     {
         createSwapChain(window);
         createImageViews();
@@ -20,8 +21,8 @@ namespace VKSwapchain
     }
 
     Swapchain::Swapchain(VKWindow::Window& window, VKDevice::Device& device,
-                         std::shared_ptr<Swapchain> previous) : 
-                         device_{device}, surface_{device.get_surface()}, oldswapchain_{previous}
+                         std::shared_ptr<Swapchain> previous, const PresentPolicy& policy) : 
+                         device_{device}, surface_{device.get_surface()}, oldswapchain_{previous}, policy_{policy}
     {
         createSwapChain(window);
         createImageViews();
@@ -45,11 +46,13 @@ namespace VKSwapchain
             swapchain_ = nullptr;
         }
 
+        for (int i = 0; i < offscreenmemorys_.size(); i++)
+            device_.destroyImage(swapchainimages_[i], offscreenmemorys_[i]);
+
         for (int i = 0; i < depthimages_.size(); i++)
         {
             vkDestroyImageView(device_.get_logic(),   depthimageviews_[i], nullptr);
-            vkDestroyImage    (device_.get_logic(),       depthimages_[i], nullptr);
-            vkFreeMemory      (device_.get_logic(), depthimagememorys_[i], nullptr);
+            device_.destroyImage(depthimages_[i], depthimagememorys_[i]);
         }
 
         for (auto framebuffer : swapchainframebuffers_)
@@ -67,44 +70,66 @@ namespace VKSwapchain
 
     VkResult Swapchain::acquireNextImage(uint32_t *imageIndex) 
     { 
-        vkWaitForFences(device_.get_logic(), 1, &inflightfence_[currentframe_], VK_TRUE, std::numeric_limits<uint64_t>::max());
-
-        auto result = vkAcquireNextImageKHR(device_.get_logic(), swapchain_, std::numeric_limits<uint64_t>::max(), 
-                                            imageavailablesemaphore_[currentframe_], VK_NULL_HANDLE, imageIndex);
+        {
+            VK_CPU_ZONE("fence wait");
+            vkWaitForFences(device_.get_logic(), 1, &inflightfence_[currentframe_], VK_TRUE, std::numeric_limits<uint64_t>::max());
+        }
 
-        if (*imageIndex >= MAX_FRAMES_IN_FLIGHT)
-            result = VK_ERROR_OUT_OF_DATE_KHR;
+        //  every frame in flight owns one offscreen image
+        if (is_offscreen())
+        {
+            *imageIndex = static_cast<uint32_t>(currentframe_);
+            return VK_SUCCESS;
+        }
 
-        return result;
+        VK_CPU_ZONE("acquire");
+        return vkAcquireNextImageKHR(device_.get_logic(), swapchain_, std::numeric_limits<uint64_t>::max(), 
+                                     imageavailablesemaphore_[currentframe_], VK_NULL_HANDLE, imageIndex);
     }
 
     VkResult Swapchain::submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex)
     {
         if (imagesinflight_[*imageIndex] != VK_NULL_HANDLE)
+        {
+            VK_CPU_ZONE("image fence wait");
             vkWaitForFences(device_.get_logic(), 1, &imagesinflight_[*imageIndex], VK_TRUE, UINT64_MAX);
+        }
         imagesinflight_[*imageIndex] = inflightfence_[currentframe_];
 
+        //  offscreen images are neither acquired nor presented, so there is nothing to synchronize with
+        uint32_t semaphoreCount = is_offscreen() ? 0 : 1;
+
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
         VkSemaphore      waitSemaphores[] =            {imageavailablesemaphore_[currentframe_]};
 
         VkPipelineStageFlags waitStages[] =      {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-        submitInfo.waitSemaphoreCount     =                                                    1;
+        submitInfo.waitSemaphoreCount     =                                       semaphoreCount;
         submitInfo.pWaitSemaphores        =                                       waitSemaphores;
         submitInfo.pWaitDstStageMask      =                                           waitStages;
         submitInfo.commandBufferCount     =                                                    1;
         submitInfo.pCommandBuffers        =                                              buffers;
 
         VkSemaphore signalSemaphores[]    =            {renderfinishedsemaphore_[currentframe_]};
-        submitInfo.signalSemaphoreCount   =                                                    1;
+        submitInfo.signalSemaphoreCount   =                                       semaphoreCount;
         submitInfo.pSignalSemaphores      =                                     signalSemaphores;
 
         vkResetFences  (device_.get_logic(), 1, &inflightfence_[currentframe_]);
 
-        auto result = vkQueueSubmit(device_.get_graphics_queue(), 1, &submitInfo, inflightfence_[currentframe_]);
+        VkResult result;
+        {
+            VK_CPU_ZONE("submit");
+            result = vkQueueSubmit(device_.get_graphics_queue(), 1, &submitInfo, inflightfence_[currentframe_]);
+        }
         if (result != VK_SUCCESS)
             throw std::runtime_error("failed to submit draw command buffer!");
+
+        if (is_offscreen())
+        {
+            currentframe_update();
+            return result;
+        }
         
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType              = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -116,7 +141,10 @@ namespace VKSwapchain
         presentInfo.pSwapchains     =                    swapChains;
         presentInfo.pImageIndices   =                    imageIndex;
 
-        vkQueuePresentKHR(device_.get_present_queue(), &presentInfo);
+        {
+            VK_CPU_ZONE("present");
+            vkQueuePresentKHR(device_.get_present_queue(), &presentInfo);
+        }
 
         currentframe_update();
 
@@ -156,11 +184,20 @@ namespace VKSwapchain
         return availableFormats[0];
     }
 
-    VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes) 
+    VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes, PresentMode mode) 
     {
-        for (const auto& availablePresentMode : availablePresentModes)
-            if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
-                return availablePresentMode;
+        std::vector<VkPresentModeKHR> preferred;
+        switch (mode)
+        {
+            case PresentMode::LowLatency:    preferred = {VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_IMMEDIATE_KHR}; break;
+            case PresentMode::Immediate:     preferred = {VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR}; break;
+            case PresentMode::AdaptiveVSync: preferred = {VK_PRESENT_MODE_FIFO_RELAXED_KHR};                           break;
+            case PresentMode::VSync:                                                                                   break;
+        }
+
+        for (auto presentMode : preferred)
+            if (std::find(availablePresentModes.begin(), availablePresentModes.end(), presentMode) != availablePresentModes.end())
+                return presentMode;
 
         return VK_PRESENT_MODE_FIFO_KHR;
     }
@@ -192,16 +229,39 @@ namespace VKSwapchain
         }
     }
 
+    void Swapchain::createOffscreenImages(VKWindow::Window& window)
+    {
+        swapchainimageformat_ = OFFSCREEN_FORMAT;
+        swapchainextent_      = window.get_extent();
+
+        swapchainimages_.resize(MAX_FRAMES_IN_FLIGHT);
+        offscreenmemorys_.resize(MAX_FRAMES_IN_FLIGHT);
+
+        for (int i = 0; i < swapchainimages_.size(); i++)
+            device_.createImage(swapchainextent_.width, swapchainextent_.height, 1, swapchainimageformat_, VK_IMAGE_TILING_OPTIMAL,
+                                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                swapchainimages_[i], offscreenmemorys_[i]);
+    }
+
     void Swapchain::createSwapChain(VKWindow::Window& window)
     {
+        if (is_offscreen())
+        {
+            createOffscreenImages(window);
+            return;
+        }
+
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device_.get_phys(), surface_);
 
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat   (swapChainSupport.formats_);
-        VkPresentModeKHR   presentMode   = chooseSwapPresentMode(swapChainSupport.presentModes_);
+        VkPresentModeKHR   presentMode   = chooseSwapPresentMode(swapChainSupport.presentModes_, policy_.mode);
         VkExtent2D         extent        = chooseSwapExtent      (swapChainSupport.capabilities_, 
                                                                                          window);
 
-        uint32_t imageCount              =      swapChainSupport.capabilities_.minImageCount + 1;
+        //  one image above the minimum lets the application render while the presentation engine holds the others;
+        //  more of them smooth out spikes at the cost of latency in fifo modes
+        uint32_t imageCount = policy_.imagecount != 0 ? policy_.imagecount : swapChainSupport.capabilities_.minImageCount + 1;
+        imageCount          =         std::max(imageCount, swapChainSupport.capabilities_.minImageCount);
         if (swapChainSupport.capabilities_.maxImageCount > 0 && 
             imageCount > swapChainSupport.capabilities_.maxImageCount)
             imageCount = swapChainSupport.capabilities_.maxImageCount;
@@ -249,6 +309,7 @@ namespace VKSwapchain
 
         swapchainimageformat_ = surfaceFormat.format;
         swapchainextent_      =               extent;
+        presentmode_          =          presentMode;
     }
 
     void Swapchain::createImageViews()
@@ -284,27 +345,6 @@ namespace VKSwapchain
         return details;
     }
 
-    void Swapchain::createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties,
-                                        VkImage &image, VkDeviceMemory &imageMemory)
-    {
-        if (vkCreateImage(device_.get_logic(), &imageInfo, nullptr, &image) != VK_SUCCESS)
-            throw std::runtime_error("failed to create image!");
-
-        VkMemoryRequirements memRequirements;
-        vkGetImageMemoryRequirements(device_.get_logic(), image, &memRequirements);
-
-        VkMemoryAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize = memRequirements.size;
-        allocInfo.memoryTypeIndex = device_.findMemoryType(device_.get_phys(), memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(device_.get_logic(), &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
-            throw std::runtime_error("failed to allocate image memory!");
-
-        if (vkBindImageMemory(device_.get_logic(), image, imageMemory, 0) != VK_SUCCESS)
-            throw std::runtime_error("failed to bind image memory!");
-    }
-
     VkFormat findSupportedFormat(VkPhysicalDevice phys_device, const std::vector<VkFormat>& candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
     {
         for (VkFormat format : candidates) 
@@ -359,7 +399,7 @@ namespace VKSwapchain
             imageInfo.sharingMode   =             VK_SHARING_MODE_EXCLUSIVE;
             imageInfo.flags         =                                     0;
 
-            createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthimages_[i], depthimagememorys_[i]);
+            device_.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthimages_[i], depthimagememorys_[i]);
 
             VkImageViewCreateInfo viewInfo{};
             viewInfo.sType     =    VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -0,0 +1,95 @@
+#include "texture_loader.hpp"
+
+#include "stb_image.h"
+
+#include <chrono>
+#include <cassert>
+#include <stdexcept>
+
+namespace VKTextureLoader
+{
+
+    void TextureLoader::request(const std::shared_ptr<VKModel::Model>& model, const std::string& filepath)
+    {
+        assert(!model->has_texture() && "Model already has a texture");
+
+        //  stbi_load keeps no shared state, workers decode side by side; compressed files are only read
+        auto image = pool_.submit([filepath, &formats = device_.get_texture_formats()]
+        {
+            Image image{};
+            int   channels = 0;
+
+            auto compressed = VKKtx::findCompressed(filepath, formats);
+            if (!compressed.empty())
+            {
+                image.compressed = VKKtx::read(compressed);
+                return image;
+            }
+
+            image.pixels = {stbi_load(filepath.c_str(), &image.width, &image.height, &channels, STBI_rgb_alpha), stbi_image_free};
+            if (!image.pixels)
+                throw std::runtime_error("failed to load texture image " + filepath + "!");
+
+            return image;
+        });
+
+        decoding_.push_back({model, std::move(image)});
+    }
+
+    void TextureLoader::update()
+    {
+        auto& uploader = device_.get_uploader();
+
+        //  the fallback slot is replaced only after the copies are done, a frame never samples a half written image
+        std::erase_if(uploading_, [&](const Upload& upload)
+        {
+            if (!uploader.isComplete(upload.ticket_))
+                return false;
+
+            if (auto model = upload.model_.lock())
+            {
+                model->publishTexture();
+                if (published_)
+                    published_(*model);
+            }
+            return true;
+        });
+
+        VkDeviceSize staged = 0;
+        std::erase_if(decoding_, [&](Decode& decode)
+        {
+            if (staged >= UPLOAD_BUDGET_PER_FRAME || decode.image_.wait_for(std::chrono::seconds::zero()) != std::future_status::ready)
+                return false;
+
+            auto image = decode.image_.get();
+            auto model = decode.model_.lock();
+            if (!model)
+                return true;
+
+            if (image.pixels)
+            {
+                staged += static_cast<VkDeviceSize>(image.width) * image.height * 4;
+                uploading_.push_back({model, model->uploadTexture(image.pixels.get(), image.width, image.height)});
+            }
+            else
+            {
+                staged += image.compressed.getSize();
+                uploading_.push_back({model, model->uploadTexture(image.compressed)});
+            }
+            return true;
+        });
+    }
+
+    void TextureLoader::flush()
+    {
+        while (!decoding_.empty() || !uploading_.empty())
+        {
+            for (auto& decode : decoding_)
+                decode.image_.wait();
+
+            update();
+            device_.get_uploader().flush();
+        }
+    }
+
+}   //  end of VKTextureLoader namespace
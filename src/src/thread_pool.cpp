@@ -0,0 +1,99 @@
+#include "thread_pool.hpp"
+#include "cpu_profiler.hpp"
+
+#include <algorithm>
+
+namespace VKThreadPool
+{
+
+    ThreadPool::ThreadPool(std::size_t threadcount)
+    {
+        if (threadcount == 0)
+            threadcount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+        workers_.reserve(threadcount);
+        for (std::size_t i = 0; i < threadcount; ++i)
+            workers_.emplace_back([this] { work(); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            stopping_ = true;
+        }
+        condition_.notify_all();
+
+        for (auto& worker : workers_)
+            worker.join();
+    }
+
+    void ThreadPool::enqueue(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            tasks_.push_back(std::move(task));
+        }
+        condition_.notify_one();
+    }
+
+    void ThreadPool::work()
+    {
+        VK_CPU_THREAD("worker");
+
+        for (;;)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock {mutex_};
+
+                auto jobpending = [this] { return jobactive_ && job_.next < job_.count; };
+                condition_.wait(lock, [&] { return stopping_ || !tasks_.empty() || jobpending(); });
+
+                //  a range of parallel_for goes ahead of queued tasks, its caller is waiting for it
+                if (jobpending())
+                {
+                    ++job_.helpers;
+                    lock.unlock();
+
+                    runJob();
+
+                    lock.lock();
+                    --job_.helpers;
+                    finished_.notify_all();
+                    continue;
+                }
+
+                //  queued work is still finished on shutdown, futures handed out stay valid
+                if (tasks_.empty())
+                    return;
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            task();
+        }
+    }
+
+    void ThreadPool::runJob()
+    {
+        for (std::size_t i = job_.next++; i < job_.count; i = job_.next++)
+        {
+            try { job_.invoke(job_.body, i); }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock {mutex_};
+                if (!job_.error)
+                    job_.error = std::current_exception();
+            }
+
+            if (++job_.done == job_.count)
+            {
+                std::lock_guard<std::mutex> lock {mutex_};
+                finished_.notify_all();
+            }
+        }
+    }
+
+}   //  end of VKThreadPool namespace
@@ -0,0 +1,270 @@
+#include "transform_system.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace VKTransformSystem
+{
+
+    namespace
+    {
+        //  rotation is Tait-Bryan Y(1), X(2), Z(3); the world matrix scales the rotated axes by the scale and
+        //  the normal matrix by the inverse scale, so both are built from one set of trig terms
+        void composeScalar(const glm::vec3& translation, const glm::vec3& rotation, const glm::vec3& scale,
+                           glm::mat4& world, glm::mat4& normal, float& maxscale)
+        {
+            const float c3 = glm::cos(rotation.z);
+            const float s3 = glm::sin(rotation.z);
+            const float c2 = glm::cos(rotation.x);
+            const float s2 = glm::sin(rotation.x);
+            const float c1 = glm::cos(rotation.y);
+            const float s1 = glm::sin(rotation.y);
+
+            const glm::vec3 axisX {c1 * c3 + s1 * s2 * s3, c2 * s3, c1 * s2 * s3 - c3 * s1};
+            const glm::vec3 axisY {c3 * s1 * s2 - c1 * s3, c2 * c3, c1 * c3 * s2 + s1 * s3};
+            const glm::vec3 axisZ {c2 * s1,                   -s2,                c1 * c2};
+
+            const glm::vec3 invScale = 1.0f / scale;
+
+            world  = glm::mat4{glm::vec4{axisX * scale.x, 0.0f},
+                               glm::vec4{axisY * scale.y, 0.0f},
+                               glm::vec4{axisZ * scale.z, 0.0f},
+                               glm::vec4{translation,     1.0f}};
+            normal = glm::mat4{glm::vec4{axisX * invScale.x, 0.0f},
+                               glm::vec4{axisY * invScale.y, 0.0f},
+                               glm::vec4{axisZ * invScale.z, 0.0f},
+                               glm::vec4{0.0f, 0.0f, 0.0f,   1.0f}};
+
+            glm::vec3 absScale = glm::abs(scale);
+            maxscale           = glm::max(glm::max(absScale.x, absScale.y), absScale.z);
+        }
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+        //  Cephes sinf/cosf: reduction to [-pi/4, pi/4] by octant in three steps, then minimax polynomials;
+        //  about one ulp for the angles transforms use
+        constexpr float FOUR_OVER_PI =                        1.27323954473516f;
+        constexpr float          DP1 =                             -0.78515625f;
+        constexpr float          DP2 =          -2.4187564849853515625e-4f;
+        constexpr float          DP3 =            -3.77489497744594108e-8f;
+        constexpr float      SIN_P0  =                        -1.9515295891e-4f;
+        constexpr float      SIN_P1  =                         8.3321608736e-3f;
+        constexpr float      SIN_P2  =                        -1.6666654611e-1f;
+        constexpr float      COS_P0  =                   2.443315711809948e-5f;
+        constexpr float      COS_P1  =                  -1.388731625493765e-3f;
+        constexpr float      COS_P2  =                   4.166664568298827e-2f;
+
+        //  one operation set per register width, the kernel below is written once against them
+        struct SSE2
+        {
+            using V = __m128;
+            static constexpr std::size_t WIDTH = 4;
+
+            static V load (const float* p)   { return _mm_loadu_ps(p); }
+            static void store(float* p, V v) { _mm_storeu_ps(p, v);    }
+            static V set  (float value)      { return _mm_set1_ps(value); }
+            static V zero ()                 { return _mm_setzero_ps(); }
+            static V add  (V a, V b)         { return _mm_add_ps(a, b); }
+            static V sub  (V a, V b)         { return _mm_sub_ps(a, b); }
+            static V mul  (V a, V b)         { return _mm_mul_ps(a, b); }
+            static V div  (V a, V b)         { return _mm_div_ps(a, b); }
+            static V max  (V a, V b)         { return _mm_max_ps(a, b); }
+            static V abs  (V a)              { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+
+            static void sincos(V x, V& sin, V& cos)
+            {
+                const __m128 signmask = _mm_set1_ps(-0.0f);
+
+                __m128 sinsign = _mm_and_ps(x, signmask);
+                x              = _mm_andnot_ps(signmask, x);
+
+                //  octant rounded up to even, its bits pick the polynomial and the signs
+                __m128i octant = _mm_cvttps_epi32(_mm_mul_ps(x, _mm_set1_ps(FOUR_OVER_PI)));
+                octant         = _mm_and_si128(_mm_add_epi32(octant, _mm_set1_epi32(1)), _mm_set1_epi32(~1));
+                __m128  y      = _mm_cvtepi32_ps(octant);
+
+                __m128 swapsin = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(octant, _mm_set1_epi32(4)), 29));
+                __m128 polymask= _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(octant, _mm_set1_epi32(2)), _mm_setzero_si128()));
+                __m128 cossign = _mm_castsi128_ps(_mm_slli_epi32(_mm_andnot_si128(_mm_sub_epi32(octant, _mm_set1_epi32(2)),
+                                                                                   _mm_set1_epi32(4)), 29));
+                sinsign        = _mm_xor_ps(sinsign, swapsin);
+
+                x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP1)));
+                x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP2)));
+                x = _mm_add_ps(x, _mm_mul_ps(y, _mm_set1_ps(DP3)));
+
+                __m128 z  = _mm_mul_ps(x, x);
+
+                __m128 pc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(COS_P0), z), _mm_set1_ps(COS_P1));
+                pc        = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(COS_P2));
+                pc        = _mm_mul_ps(_mm_mul_ps(pc, z), z);
+                pc        = _mm_add_ps(_mm_sub_ps(pc, _mm_mul_ps(z, _mm_set1_ps(0.5f))), _mm_set1_ps(1.0f));
+
+                __m128 ps = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(SIN_P0), z), _mm_set1_ps(SIN_P1));
+                ps        = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(SIN_P2));
+                ps        = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), x), x);
+
+                sin = _mm_or_ps(_mm_and_ps(polymask, ps), _mm_andnot_ps(polymask, pc));
+                cos = _mm_or_ps(_mm_and_ps(polymask, pc), _mm_andnot_ps(polymask, ps));
+
+                sin = _mm_xor_ps(sin, sinsign);
+                cos = _mm_xor_ps(cos, cossign);
+            }
+
+            //  column `column` of WIDTH consecutive matrices from its four components
+            static void storeColumn(glm::mat4* out, int column, V x, V y, V z, V w)
+            {
+                _MM_TRANSPOSE4_PS(x, y, z, w);
+
+                _mm_storeu_ps(reinterpret_cast<float *>(out + 0) + 4 * column, x);
+                _mm_storeu_ps(reinterpret_cast<float *>(out + 1) + 4 * column, y);
+                _mm_storeu_ps(reinterpret_cast<float *>(out + 2) + 4 * column, z);
+                _mm_storeu_ps(reinterpret_cast<float *>(out + 3) + 4 * column, w);
+            }
+        };
+
+#if defined(__AVX2__)
+        struct AVX2
+        {
+            using V = __m256;
+            static constexpr std::size_t WIDTH = 8;
+
+            static V load (const float* p)   { return _mm256_loadu_ps(p); }
+            static void store(float* p, V v) { _mm256_storeu_ps(p, v);    }
+            static V set  (float value)      { return _mm256_set1_ps(value); }
+            static V zero ()                 { return _mm256_setzero_ps(); }
+            static V add  (V a, V b)         { return _mm256_add_ps(a, b); }
+            static V sub  (V a, V b)         { return _mm256_sub_ps(a, b); }
+            static V mul  (V a, V b)         { return _mm256_mul_ps(a, b); }
+            static V div  (V a, V b)         { return _mm256_div_ps(a, b); }
+            static V max  (V a, V b)         { return _mm256_max_ps(a, b); }
+            static V abs  (V a)              { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+
+            static void sincos(V x, V& sin, V& cos)
+            {
+                const __m256 signmask = _mm256_set1_ps(-0.0f);
+
+                __m256 sinsign = _mm256_and_ps(x, signmask);
+                x              = _mm256_andnot_ps(signmask, x);
+
+                __m256i octant = _mm256_cvttps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(FOUR_OVER_PI)));
+                octant         = _mm256_and_si256(_mm256_add_epi32(octant, _mm256_set1_epi32(1)), _mm256_set1_epi32(~1));
+                __m256  y      = _mm256_cvtepi32_ps(octant);
+
+                __m256 swapsin = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(4)), 29));
+                __m256 polymask= _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(octant, _mm256_set1_epi32(2)), _mm256_setzero_si256()));
+                __m256 cossign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_andnot_si256(_mm256_sub_epi32(octant, _mm256_set1_epi32(2)),
+                                                                                            _mm256_set1_epi32(4)), 29));
+                sinsign        = _mm256_xor_ps(sinsign, swapsin);
+
+                x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP1)));
+                x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP2)));
+                x = _mm256_add_ps(x, _mm256_mul_ps(y, _mm256_set1_ps(DP3)));
+
+                __m256 z  = _mm256_mul_ps(x, x);
+
+                __m256 pc = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(COS_P0), z), _mm256_set1_ps(COS_P1));
+                pc        = _mm256_add_ps(_mm256_mul_ps(pc, z), _mm256_set1_ps(COS_P2));
+                pc        = _mm256_mul_ps(_mm256_mul_ps(pc, z), z);
+                pc        = _mm256_add_ps(_mm256_sub_ps(pc, _mm256_mul_ps(z, _mm256_set1_ps(0.5f))), _mm256_set1_ps(1.0f));
+
+                __m256 ps = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(SIN_P0), z), _mm256_set1_ps(SIN_P1));
+                ps        = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(SIN_P2));
+                ps        = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ps, z), x), x);
+
+                sin = _mm256_blendv_ps(pc, ps, polymask);
+                cos = _mm256_blendv_ps(ps, pc, polymask);
+
+                sin = _mm256_xor_ps(sin, sinsign);
+                cos = _mm256_xor_ps(cos, cossign);
+            }
+
+            //  both halves go through the 4x4 transpose of the SSE path
+            static void storeColumn(glm::mat4* out, int column, V x, V y, V z, V w)
+            {
+                SSE2::storeColumn(out,     column, _mm256_castps256_ps128(x),   _mm256_castps256_ps128(y),
+                                                   _mm256_castps256_ps128(z),   _mm256_castps256_ps128(w));
+                SSE2::storeColumn(out + 4, column, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1),
+                                                   _mm256_extractf128_ps(z, 1), _mm256_extractf128_ps(w, 1));
+            }
+        };
+#endif
+
+        //  composes transforms [index, index + WIDTH) the same way composeScalar does
+        template <typename L>
+        void composeLanes(const Components& translations, const Components& rotations, const Components& scales,
+                          std::size_t index, glm::mat4* worlds, glm::mat4* normals, float* maxscales)
+        {
+            using V = typename L::V;
+
+            V s1, c1, s2, c2, s3, c3;
+            L::sincos(L::load(rotations.y.data() + index), s1, c1);
+            L::sincos(L::load(rotations.x.data() + index), s2, c2);
+            L::sincos(L::load(rotations.z.data() + index), s3, c3);
+
+            V s1s2 = L::mul(s1, s2);
+            V c1s2 = L::mul(c1, s2);
+
+            V axisXx = L::add(L::mul(c1, c3), L::mul(s1s2, s3));
+            V axisXy =                          L::mul(c2, s3);
+            V axisXz = L::sub(L::mul(c1s2, s3), L::mul(c3, s1));
+
+            V axisYx = L::sub(L::mul(s1s2, c3), L::mul(c1, s3));
+            V axisYy =                          L::mul(c2, c3);
+            V axisYz = L::add(L::mul(c1s2, c3), L::mul(s1, s3));
+
+            V axisZx =                       L::mul(c2, s1);
+            V axisZy =                   L::sub(L::zero(), s2);
+            V axisZz =                       L::mul(c1, c2);
+
+            V sx = L::load(scales.x.data() + index);
+            V sy = L::load(scales.y.data() + index);
+            V sz = L::load(scales.z.data() + index);
+
+            V one = L::set(1.0f);
+            V isx = L::div(one, sx);
+            V isy = L::div(one, sy);
+            V isz = L::div(one, sz);
+
+            V zero = L::zero();
+
+            glm::mat4* world = worlds + index;
+            L::storeColumn(world, 0, L::mul(axisXx, sx), L::mul(axisXy, sx), L::mul(axisXz, sx), zero);
+            L::storeColumn(world, 1, L::mul(axisYx, sy), L::mul(axisYy, sy), L::mul(axisYz, sy), zero);
+            L::storeColumn(world, 2, L::mul(axisZx, sz), L::mul(axisZy, sz), L::mul(axisZz, sz), zero);
+            L::storeColumn(world, 3, L::load(translations.x.data() + index), L::load(translations.y.data() + index),
+                                     L::load(translations.z.data() + index), one);
+
+            glm::mat4* normal = normals + index;
+            L::storeColumn(normal, 0, L::mul(axisXx, isx), L::mul(axisXy, isx), L::mul(axisXz, isx), zero);
+            L::storeColumn(normal, 1, L::mul(axisYx, isy), L::mul(axisYy, isy), L::mul(axisYz, isy), zero);
+            L::storeColumn(normal, 2, L::mul(axisZx, isz), L::mul(axisZy, isz), L::mul(axisZz, isz), zero);
+            L::storeColumn(normal, 3, zero, zero, zero, one);
+
+            L::store(maxscales + index, L::max(L::max(L::abs(sx), L::abs(sy)), L::abs(sz)));
+        }
+#endif
+    }
+
+    void composeMatrices(const Components& translations, const Components& rotations, const Components& scales,
+                         glm::mat4* worlds, glm::mat4* normals, float* maxscales)
+    {
+        std::size_t count = translations.size();
+        std::size_t index =                   0;
+
+#if defined(__AVX2__)
+        for (; index + AVX2::WIDTH <= count; index += AVX2::WIDTH)
+            composeLanes<AVX2>(translations, rotations, scales, index, worlds, normals, maxscales);
+#endif
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+        for (; index + SSE2::WIDTH <= count; index += SSE2::WIDTH)
+            composeLanes<SSE2>(translations, rotations, scales, index, worlds, normals, maxscales);
+#endif
+
+        //  tail of the batches, or everything without SIMD
+        for (; index < count; ++index)
+            composeScalar(translations.get(index), rotations.get(index), scales.get(index),
+                          worlds[index], normals[index], maxscales[index]);
+    }
+
+}   //  end of VKTransformSystem namespace
@@ -0,0 +1,71 @@
+#include "transform_system.hpp"
+
+namespace VKTransformSystem
+{
+
+    void TransformSystem::set(uint32_t id, const VKObject::Transform3Dcomponent& transform)
+    {
+        grow(id);
+
+        translations_.set(id, transform.translation);
+        rotations_   .set(id,    transform.rotation);
+        scales_      .set(id,       transform.scale);
+        markDirty(id);
+    }
+
+    void TransformSystem::grow(uint32_t id)
+    {
+        if (id < translations_.size())
+            return;
+
+        std::size_t count = static_cast<std::size_t>(id) + 1;
+
+        translations_.resize(count, glm::vec3{0.0f});
+        rotations_   .resize(count, glm::vec3{0.0f});
+        scales_      .resize(count, glm::vec3{1.0f});
+        worlds_      .resize(count, glm::mat4{1.0f});
+        normals_     .resize(count, glm::mat4{1.0f});
+        maxscales_   .resize(count,             1.0f);
+        dirty_       .resize(count,                0);
+    }
+
+    void TransformSystem::update()
+    {
+        updated_.clear();
+        if (dirtylist_.empty())
+            return;
+
+        //  dirty entries are scattered over the arrays, the kernel wants them contiguous
+        packedtranslations_.clear();
+        packedrotations_.clear();
+        packedscales_.clear();
+
+        for (uint32_t id : dirtylist_)
+        {
+            packedtranslations_.push_back(translations_.get(id));
+            packedrotations_   .push_back(   rotations_.get(id));
+            packedscales_      .push_back(      scales_.get(id));
+        }
+
+        packedworlds_   .resize(dirtylist_.size());
+        packednormals_  .resize(dirtylist_.size());
+        packedmaxscales_.resize(dirtylist_.size());
+
+        composeMatrices(packedtranslations_, packedrotations_, packedscales_,
+                        packedworlds_.data(), packednormals_.data(), packedmaxscales_.data());
+
+        for (std::size_t packed = 0; packed < dirtylist_.size(); ++packed)
+        {
+            uint32_t id = dirtylist_[packed];
+
+            worlds_   [id] =    packedworlds_[packed];
+            normals_  [id] =   packednormals_[packed];
+            maxscales_[id] = packedmaxscales_[packed];
+            dirty_    [id] =                        0;
+        }
+
+        //  the list becomes the updated one, both keep their storage
+        updated_.swap(dirtylist_);
+    }
+
+}   //  end of VKTransformSystem namespace
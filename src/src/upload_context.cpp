@@ -0,0 +1,553 @@
+#include "upload_context.hpp"
+
+#include <stdexcept>
+#include <algorithm>
+
+namespace VKUpload
+{
+
+    namespace
+    {
+        VkCommandPool createPool(VkDevice device, uint32_t family)
+        {
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType            =                                 VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex =                                                                          family;
+
+            VkCommandPool pool;
+            if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS)
+                throw std::runtime_error("failed to create upload command pool!");
+
+            return pool;
+        }
+
+        VkCommandBuffer allocateCommandBuffer(VkDevice device, VkCommandPool pool)
+        {
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType              = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.level              =                VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+            allocInfo.commandPool        =                                           pool;
+            allocInfo.commandBufferCount =                                              1;
+
+            VkCommandBuffer commandBuffer;
+            if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS)
+                throw std::runtime_error("failed to allocate upload command buffer!");
+
+            return commandBuffer;
+        }
+
+        VkFence createFence(VkDevice device)
+        {
+            VkFenceCreateInfo fenceInfo{};
+            fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+            VkFence fence;
+            if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+                throw std::runtime_error("failed to create upload fence!");
+
+            return fence;
+        }
+
+        void recordMipmaps(VkCommandBuffer commandBuffer, VkImage image, int32_t width, int32_t height, uint32_t mipLevels)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcQueueFamilyIndex             =                VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex             =                VK_QUEUE_FAMILY_IGNORED;
+            barrier.image                           =                                  image;
+            barrier.subresourceRange.aspectMask     =              VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.levelCount     =                                      1;
+            barrier.subresourceRange.baseArrayLayer =                                      0;
+            barrier.subresourceRange.layerCount     =                                      1;
+
+            //  every level is read by the blit of the next one and then handed over to the shaders
+            for (uint32_t level = 1; level < mipLevels; ++level)
+            {
+                barrier.subresourceRange.baseMipLevel =                            level - 1;
+                barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+                barrier.newLayout                     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+                barrier.srcAccessMask                 =         VK_ACCESS_TRANSFER_WRITE_BIT;
+                barrier.dstAccessMask                 =          VK_ACCESS_TRANSFER_READ_BIT;
+
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                                     0, nullptr, 0, nullptr, 1, &barrier);
+
+                int32_t nextwidth  = width  > 1 ? width  / 2 : 1;
+                int32_t nextheight = height > 1 ? height / 2 : 1;
+
+                VkImageBlit blit{};
+                blit.srcOffsets[0]                 =                  {0, 0, 0};
+                blit.srcOffsets[1]                 =          {width, height, 1};
+                blit.srcSubresource.aspectMask     =  VK_IMAGE_ASPECT_COLOR_BIT;
+                blit.srcSubresource.mipLevel       =                  level - 1;
+                blit.srcSubresource.baseArrayLayer =                          0;
+                blit.srcSubresource.layerCount     =                          1;
+                blit.dstOffsets[0]                 =                  {0, 0, 0};
+                blit.dstOffsets[1]                 =  {nextwidth, nextheight, 1};
+                blit.dstSubresource.aspectMask     =  VK_IMAGE_ASPECT_COLOR_BIT;
+                blit.dstSubresource.mipLevel       =                      level;
+                blit.dstSubresource.baseArrayLayer =                          0;
+                blit.dstSubresource.layerCount     =                          1;
+
+                vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                               1, &blit, VK_FILTER_LINEAR);
+
+                barrier.oldLayout     =     VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+                barrier.newLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+                barrier.srcAccessMask =              VK_ACCESS_TRANSFER_READ_BIT;
+                barrier.dstAccessMask =                VK_ACCESS_SHADER_READ_BIT;
+
+                vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                                     0, nullptr, 0, nullptr, 1, &barrier);
+
+                width  =  nextwidth;
+                height = nextheight;
+            }
+
+            barrier.subresourceRange.baseMipLevel =                        mipLevels - 1;
+            barrier.oldLayout                     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            barrier.newLayout                     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+            barrier.srcAccessMask                 =         VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask                 =            VK_ACCESS_SHADER_READ_BIT;
+
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                                 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        //  stages and accesses through which uploaded resources are consumed by the frames
+        constexpr VkPipelineStageFlags CONSUMER_STAGES = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT |
+                                                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        constexpr VkAccessFlags        CONSUMER_ACCESS = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT |
+                                                         VK_ACCESS_UNIFORM_READ_BIT          | VK_ACCESS_SHADER_READ_BIT;
+    }
+
+    UploadContext::UploadContext(VKDevice::Device& device) : device_{device}
+    {
+        dedicated_   =           device_.has_dedicated_transfer();
+        queue_       =               device_.get_transfer_queue();
+        commandpool_ = createPool(device_.get_logic(), device_.get_indices().get_transfer_value());
+
+        if (dedicated_)
+            acquirecommandpool_ = createPool(device_.get_logic(), device_.get_indices().get_graphics_value());
+
+        ring_ = std::make_unique<VKBuffmanager::Buffmanager>(device_, STAGING_RING_SIZE, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        ring_->map();
+
+        ringalign_ = std::max<VkDeviceSize>(ringalign_, device_.get_properties().limits.optimalBufferCopyOffsetAlignment);
+    }
+
+    UploadContext::~UploadContext()
+    {
+        flush();
+        for (auto& batch : inflight_)
+            if (batch.acquirefence_ != VK_NULL_HANDLE)
+                vkWaitForFences(device_.get_logic(), 1, &batch.acquirefence_, VK_TRUE, UINT64_MAX);
+
+        collect();
+
+        for (auto& batch : free_)
+        {
+            vkDestroyFence(device_.get_logic(), batch.fence_, nullptr);
+            if (dedicated_)
+            {
+                vkDestroyFence    (device_.get_logic(), batch.acquirefence_, nullptr);
+                vkDestroySemaphore(device_.get_logic(),    batch.semaphore_, nullptr);
+            }
+        }
+
+        vkDestroyCommandPool(device_.get_logic(), commandpool_, nullptr);
+        if (acquirecommandpool_ != VK_NULL_HANDLE)
+            vkDestroyCommandPool(device_.get_logic(), acquirecommandpool_, nullptr);
+    }
+
+    VkCommandBuffer UploadContext::begin()
+    {
+        if (hasrecording_)
+            return recording_.commandbuffer_;
+
+        //  command buffers, fences and semaphores of finished batches are recycled
+        collect();
+        if (!free_.empty())
+        {
+            recording_ = std::move(free_.back());
+            free_.pop_back();
+        }
+
+        if (recording_.commandbuffer_ == VK_NULL_HANDLE)
+        {
+            recording_.commandbuffer_ = allocateCommandBuffer(device_.get_logic(), commandpool_);
+            recording_.fence_         =                             createFence(device_.get_logic());
+
+            if (dedicated_)
+            {
+                recording_.acquirebuff_  = allocateCommandBuffer(device_.get_logic(), acquirecommandpool_);
+                recording_.acquirefence_ =                                    createFence(device_.get_logic());
+
+                VkSemaphoreCreateInfo semaphoreInfo{};
+                semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+                if (vkCreateSemaphore(device_.get_logic(), &semaphoreInfo, nullptr, &recording_.semaphore_) != VK_SUCCESS)
+                    throw std::runtime_error("failed to create upload semaphore!");
+            }
+        }
+
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(recording_.commandbuffer_, &beginInfo);
+
+        hasrecording_ = true;
+        return recording_.commandbuffer_;
+    }
+
+    bool UploadContext::reserveRing(VkDeviceSize size, VkDeviceSize& offset, VkDeviceSize& consumed)
+    {
+        if (ringused_ == 0)
+            ringhead_ = 0;
+
+        VkDeviceSize start   = (ringhead_ + ringalign_ - 1) / ringalign_ * ringalign_;
+        VkDeviceSize padding =                                     start - ringhead_;
+
+        //  a region never wraps around, the rest of the ring is skipped instead
+        if (start + size > STAGING_RING_SIZE)
+        {
+            padding = STAGING_RING_SIZE - ringhead_;
+            start   =                             0;
+        }
+
+        if (ringused_ + padding + size > STAGING_RING_SIZE)
+            return false;
+
+        offset     =          start;
+        consumed   = padding + size;
+        ringhead_  =   start + size;
+        ringused_ +=       consumed;
+
+        return true;
+    }
+
+    Staging UploadContext::stage(const void* data, VkDeviceSize size)
+    {
+        if (size > STAGING_RING_SIZE)
+        {
+            begin();
+
+            auto staging = std::make_unique<VKBuffmanager::Buffmanager>(device_, size, 1, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                                                                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            staging->map();
+            staging->writeToBuffer(const_cast<void *>(data));
+
+            VkBuffer buffer = staging->getBuffer();
+            recording_.staging_.push_back(std::move(staging));
+
+            return Staging{buffer, 0};
+        }
+
+        VkDeviceSize offset   = 0;
+        VkDeviceSize consumed = 0;
+        while (!reserveRing(size, offset, consumed))
+        {
+            //  the ring is full: everything recorded goes out and the oldest batch gives its space back
+            submit();
+
+            //  only unfinished batches hold ring space, collect() has given back that of all others
+            auto oldest = std::find_if(inflight_.begin(), inflight_.end(), [](const Batch& batch) { return !batch.finished_; });
+            if (oldest == inflight_.end())
+                throw std::runtime_error("failed to stage upload: staging ring is full without uploads in flight!");
+
+            wait(oldest->ticket_);
+        }
+
+        begin();
+        recording_.ringbytes_ += consumed;
+
+        ring_->writeToBuffer(const_cast<void *>(data), size, offset);
+
+        return Staging{ring_->getBuffer(), offset};
+    }
+
+    void UploadContext::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size, VkDeviceSize srcOffset, VkDeviceSize dstOffset)
+    {
+        VkCommandBuffer commandBuffer = begin();
+
+        VkBufferCopy copyRegion {};
+        copyRegion.srcOffset = srcOffset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size      =      size;
+        vkCmdCopyBuffer (commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+
+        hasbuffercopy_ = true;
+
+        if (!dedicated_)
+            return;
+
+        //  release half of the ownership transfer, the acquire half is replayed on the graphics queue
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType               =    VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask       =               VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask       =                                          0;
+        barrier.srcQueueFamilyIndex = device_.get_indices().get_transfer_value();
+        barrier.dstQueueFamilyIndex = device_.get_indices().get_graphics_value();
+        barrier.buffer              =                                  dstBuffer;
+        barrier.offset              =                                  dstOffset;
+        barrier.size                =                                       size;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                             0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+        barrier.srcAccessMask =               0;
+        barrier.dstAccessMask = CONSUMER_ACCESS;
+        recording_.bufferbarriers_.push_back(barrier);
+    }
+
+    void UploadContext::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, VkDeviceSize bufferOffset, uint32_t mipLevel)
+    {
+        VkCommandBuffer commandBuffer = begin();
+
+        VkBufferImageCopy region{};
+        region.bufferOffset                    =              bufferOffset;
+        region.bufferRowLength                 =                         0;
+        region.bufferImageHeight               =                         0;
+        region.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel       =                  mipLevel;
+        region.imageSubresource.baseArrayLayer =                         0;
+        region.imageSubresource.layerCount     =                         1;
+        region.imageOffset                     =                 {0, 0, 0};
+        region.imageExtent                     =        {width, height, 1};
+
+        vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    }
+
+    void UploadContext::transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
+    {
+        VkCommandBuffer commandBuffer = begin();
+
+        VkImageMemoryBarrier barrier{};
+        barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout                       =                              oldLayout;
+        barrier.newLayout                       =                              newLayout;
+        barrier.srcQueueFamilyIndex             =                VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex             =                VK_QUEUE_FAMILY_IGNORED;
+        barrier.image                           =                                  image;
+        barrier.subresourceRange.aspectMask     =              VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel   =                                      0;
+        barrier.subresourceRange.levelCount     =                              mipLevels;
+        barrier.subresourceRange.baseArrayLayer =                                      0;
+        barrier.subresourceRange.layerCount     =                                      1;
+
+        VkPipelineStageFlags sourceStage;
+        VkPipelineStageFlags destinationStage;
+
+        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL)
+        {
+            barrier.srcAccessMask =                                     0;
+            barrier.dstAccessMask =          VK_ACCESS_TRANSFER_WRITE_BIT;
+
+            sourceStage           =     VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+            destinationStage      =        VK_PIPELINE_STAGE_TRANSFER_BIT;
+        }
+        else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)
+        {
+            barrier.srcAccessMask =          VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask =             VK_ACCESS_SHADER_READ_BIT;
+
+            sourceStage           =        VK_PIPELINE_STAGE_TRANSFER_BIT;
+            destinationStage      = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+
+            //  the transfer queue can not reach the fragment stage: the layout change becomes the ownership
+            //  transfer, both halves of it carry the same layouts
+            if (dedicated_)
+            {
+                barrier.dstAccessMask       =                                          0;
+                barrier.srcQueueFamilyIndex = device_.get_indices().get_transfer_value();
+                barrier.dstQueueFamilyIndex = device_.get_indices().get_graphics_value();
+                destinationStage            =       VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+                VkImageMemoryBarrier acquire = barrier;
+                acquire.srcAccessMask =                         0;
+                acquire.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+                recording_.imagebarriers_.push_back(acquire);
+            }
+        }
+        else
+            throw std::invalid_argument("unsupported layout transition!");
+
+        vkCmdPipelineBarrier (commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+
+    void UploadContext::generateMipmaps(VkImage image, int32_t width, int32_t height, uint32_t mipLevels)
+    {
+        VkCommandBuffer commandBuffer = begin();
+
+        if (!dedicated_)
+        {
+            recordMipmaps(commandBuffer, image, width, height, mipLevels);
+            return;
+        }
+
+        //  transfer queues can not blit: the whole image moves to the graphics queue which builds the chain
+        VkImageMemoryBarrier barrier{};
+        barrier.sType                           =     VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.oldLayout                       =       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout                       =       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.srcAccessMask                   =               VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask                   =                                          0;
+        barrier.srcQueueFamilyIndex             = device_.get_indices().get_transfer_value();
+        barrier.dstQueueFamilyIndex             = device_.get_indices().get_graphics_value();
+        barrier.image                           =                                      image;
+        barrier.subresourceRange.aspectMask     =                  VK_IMAGE_ASPECT_COLOR_BIT;
+        barrier.subresourceRange.baseMipLevel   =                                          0;
+        barrier.subresourceRange.levelCount     =                                  mipLevels;
+        barrier.subresourceRange.baseArrayLayer =                                          0;
+        barrier.subresourceRange.layerCount     =                                          1;
+
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+                             0, nullptr, 0, nullptr, 1, &barrier);
+
+        barrier.srcAccessMask =                                                     0;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+        recording_.imagebarriers_.push_back(barrier);
+        recording_.mipchains_.push_back(MipChain{image, width, height, mipLevels});
+    }
+
+    uint64_t UploadContext::submit()
+    {
+        collect();
+
+        if (!hasrecording_)
+            return nextticket_ - 1;
+
+        //  on a shared queue barriers reach over submission boundaries, so frames submitted later
+        //  read the copied vertices and indices without any host wait
+        if (hasbuffercopy_ && !dedicated_)
+        {
+            VkMemoryBarrier barrier{};
+            barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask =     VK_ACCESS_TRANSFER_WRITE_BIT;
+            barrier.dstAccessMask =                  CONSUMER_ACCESS;
+
+            vkCmdPipelineBarrier(recording_.commandbuffer_, VK_PIPELINE_STAGE_TRANSFER_BIT, CONSUMER_STAGES,
+                                 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+        vkEndCommandBuffer(recording_.commandbuffer_);
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType                =    VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount   =                                1;
+        submitInfo.pCommandBuffers      =      &recording_.commandbuffer_;
+        submitInfo.signalSemaphoreCount =               dedicated_ ? 1 : 0;
+        submitInfo.pSignalSemaphores    =           &recording_.semaphore_;
+
+        if (vkQueueSubmit(queue_, 1, &submitInfo, recording_.fence_) != VK_SUCCESS)
+            throw std::runtime_error("failed to submit upload command buffer!");
+
+        recording_.ticket_ = nextticket_++;
+        if (!dedicated_)
+            readyticket_ = recording_.ticket_;
+
+        inflight_.push_back(std::move(recording_));
+
+        recording_     = Batch{};
+        hasrecording_  =   false;
+        hasbuffercopy_ =   false;
+
+        return inflight_.back().ticket_;
+    }
+
+    void UploadContext::acquireBatch(Batch& batch)
+    {
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(batch.acquirebuff_, &beginInfo);
+        vkCmdPipelineBarrier(batch.acquirebuff_, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, CONSUMER_STAGES | VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+                             static_cast<uint32_t>(batch.bufferbarriers_.size()), batch.bufferbarriers_.data(),
+                             static_cast<uint32_t>(batch.imagebarriers_.size()),   batch.imagebarriers_.data());
+
+        for (auto& chain : batch.mipchains_)
+            recordMipmaps(batch.acquirebuff_, chain.image, chain.width, chain.height, chain.miplevels);
+        vkEndCommandBuffer(batch.acquirebuff_);
+
+        //  the transfer is already finished here, so the wait never holds the graphics queue back
+        VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.waitSemaphoreCount   =                             1;
+        submitInfo.pWaitSemaphores      =             &batch.semaphore_;
+        submitInfo.pWaitDstStageMask    =                    &waitStage;
+        submitInfo.commandBufferCount   =                             1;
+        submitInfo.pCommandBuffers      =           &batch.acquirebuff_;
+
+        if (vkQueueSubmit(device_.get_graphics_queue(), 1, &submitInfo, batch.acquirefence_) != VK_SUCCESS)
+            throw std::runtime_error("failed to submit upload acquire command buffer!");
+
+        readyticket_ = batch.ticket_;
+    }
+
+    void UploadContext::wait(uint64_t ticket)
+    {
+        for (auto& batch : inflight_)
+            if (batch.ticket_ <= ticket)
+                vkWaitForFences(device_.get_logic(), 1, &batch.fence_, VK_TRUE, UINT64_MAX);
+
+        collect();
+    }
+
+    void UploadContext::collect()
+    {
+        //  batches finish in submission order, so polling stops at the first unfinished one
+        for (auto& batch : inflight_)
+        {
+            if (batch.finished_)
+                continue;
+            if (vkGetFenceStatus(device_.get_logic(), batch.fence_) != VK_SUCCESS)
+                break;
+
+            batch.finished_ = true;
+
+            //  copies have read the staging data, its space can be handed to the next uploads
+            ringused_ -= batch.ringbytes_;
+            batch.ringbytes_ = 0;
+            batch.staging_.clear();
+
+            if (dedicated_)
+                acquireBatch(batch);
+        }
+
+        while (!inflight_.empty())
+        {
+            auto& batch = inflight_.front();
+
+            if (!batch.finished_ || (dedicated_ && vkGetFenceStatus(device_.get_logic(), batch.acquirefence_) != VK_SUCCESS))
+                break;
+
+            releaseBatch(batch);
+            free_.push_back(std::move(batch));
+            inflight_.pop_front();
+        }
+    }
+
+    void UploadContext::releaseBatch(Batch& batch)
+    {
+        batch.bufferbarriers_.clear();
+        batch.imagebarriers_.clear();
+        batch.mipchains_.clear();
+        batch.finished_ = false;
+
+        vkResetFences(device_.get_logic(), 1, &batch.fence_);
+        vkResetCommandBuffer(batch.commandbuffer_, 0);
+
+        if (dedicated_)
+        {
+            vkResetFences(device_.get_logic(), 1, &batch.acquirefence_);
+            vkResetCommandBuffer(batch.acquirebuff_, 0);
+        }
+    }
+
+}   //  end of VKUpload namespace
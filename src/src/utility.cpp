@@ -20,4 +20,27 @@ namespace Service
         return buffer;
     }
 
+    uint64_t hashfile(const std::string& filename)
+    {
+        std::ifstream file(filename, std::ios::binary);
+
+        if (!file.is_open())
+            throw std::runtime_error("failed to open file!" + filename);
+
+        uint64_t hash = 0xcbf29ce484222325ull;
+        char chunk[64 * 1024];
+
+        while (file)
+        {
+            file.read(chunk, sizeof(chunk));
+            for (std::streamsize i = 0, len = file.gcount(); i < len; ++i)
+            {
+                hash ^= static_cast<unsigned char>(chunk[i]);
+                hash *= 0x100000001b3ull;
+            }
+        }
+
+        return hash;
+    }
+
 }      //  end of the Service namespace
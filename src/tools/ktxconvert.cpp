@@ -0,0 +1,396 @@
+#include "ktx.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <map>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+//  offline converter of textures to the KTX2 files Model and TextureLoader pick up next to the source image.
+//  The encoders aim at fast, predictable results: one principal axis fit per block, BC7 always in mode 6
+namespace
+{
+    using Texel = std::array<float, 4>;
+    using Block = std::array<Texel, 16>;
+
+    struct BitWriter
+    {
+        std::array<unsigned char, 16>& bytes;
+        uint32_t                         bit = 0;
+
+        void put(uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i, ++bit)
+                bytes[bit / 8] |= static_cast<unsigned char>(((value >> i) & 1u) << (bit % 8));
+        }
+    };
+
+    template <std::size_t N>
+    float distance(const Texel& a, const Texel& b)
+    {
+        float sum = 0.0f;
+        for (std::size_t c = 0; c < N; ++c)
+            sum += (a[c] - b[c]) * (a[c] - b[c]);
+
+        return sum;
+    }
+
+    //  ends of the segment through the texels along their direction of largest variance; texels with a zero weight are ignored
+    template <std::size_t N>
+    void fitEndpoints(const Block& block, const std::array<float, 16>& weights, Texel& high, Texel& low)
+    {
+        Texel mean{};
+        float total = 0.0f;
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            for (std::size_t c = 0; c < N; ++c)
+                mean[c] += block[i][c] * weights[i];
+            total += weights[i];
+        }
+        for (std::size_t c = 0; c < N; ++c)
+            mean[c] /= total;
+
+        float covariance[N][N]{};
+        for (std::size_t i = 0; i < 16; ++i)
+            for (std::size_t r = 0; r < N; ++r)
+                for (std::size_t c = 0; c < N; ++c)
+                    covariance[r][c] += (block[i][r] - mean[r]) * (block[i][c] - mean[c]) * weights[i];
+
+        //  power iteration, a handful of steps is plenty for 16 points. A fixed seed like (1,1,1) can be orthogonal to the
+        //  variance, e.g. on a red to green edge, so it starts from the covariance column of largest norm instead, which
+        //  lies in the span the texels actually vary in
+        std::size_t seed     = 0;
+        float       seednorm = 0.0f;
+        for (std::size_t c = 0; c < N; ++c)
+        {
+            float norm = 0.0f;
+            for (std::size_t r = 0; r < N; ++r)
+                norm += covariance[r][c] * covariance[r][c];
+
+            if (norm > seednorm)
+            {
+                seed     =    c;
+                seednorm = norm;
+            }
+        }
+
+        //  a flat block has no variance at all, any axis gives the same endpoints
+        Texel axis{};
+        axis[seed] = 1.0f;
+        if (seednorm > 0.0f)
+            for (std::size_t r = 0; r < N; ++r)
+                axis[r] = covariance[r][seed] / std::sqrt(seednorm);
+
+        for (int step = 0; step < 8; ++step)
+        {
+            Texel next{};
+            for (std::size_t r = 0; r < N; ++r)
+                for (std::size_t c = 0; c < N; ++c)
+                    next[r] += covariance[r][c] * axis[c];
+
+            float length = std::sqrt(distance<N>(next, Texel{}));
+            if (length < 1e-6f)
+                break;
+            for (std::size_t c = 0; c < N; ++c)
+                axis[c] = next[c] / length;
+        }
+
+        float lowest = 0.0f, highest = 0.0f;
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            if (weights[i] == 0.0f)
+                continue;
+
+            float t = 0.0f;
+            for (std::size_t c = 0; c < N; ++c)
+                t += (block[i][c] - mean[c]) * axis[c];
+
+            lowest  = std::min(lowest,  t);
+            highest = std::max(highest, t);
+        }
+
+        for (std::size_t c = 0; c < N; ++c)
+        {
+            high[c] = std::clamp(mean[c] + axis[c] * highest, 0.0f, 255.0f);
+            low [c] = std::clamp(mean[c] + axis[c] * lowest,  0.0f, 255.0f);
+        }
+    }
+
+    uint16_t pack565(const Texel& colour)
+    {
+        auto r = static_cast<uint16_t>(std::lround(colour[0] * 31.0f / 255.0f));
+        auto g = static_cast<uint16_t>(std::lround(colour[1] * 63.0f / 255.0f));
+        auto b = static_cast<uint16_t>(std::lround(colour[2] * 31.0f / 255.0f));
+
+        return static_cast<uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    Texel unpack565(uint16_t packed)
+    {
+        uint32_t r = packed >> 11, g = (packed >> 5) & 63, b = packed & 31;
+        return {static_cast<float>(r << 3 | r >> 2), static_cast<float>(g << 2 | g >> 4), static_cast<float>(b << 3 | b >> 2), 255.0f};
+    }
+
+    //  texels with alpha below one half use the punch-through mode of BC1, which gives up one of the interpolated colours
+    std::array<unsigned char, 16> encodeBC1(const Block& block)
+    {
+        std::array<float, 16> weights{};
+        bool transparent = false;
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            weights[i]   = block[i][3] < 128.0f ? 0.0f : 1.0f;
+            transparent |= weights[i] == 0.0f;
+        }
+
+        std::array<unsigned char, 16> bytes{};
+        if (std::all_of(weights.begin(), weights.end(), [](float weight) { return weight == 0.0f; }))
+        {
+            std::memset(bytes.data() + 4, 0xFF, 4);   //  both colours black, every index the transparent one
+            return bytes;
+        }
+
+        Texel high, low;
+        fitEndpoints<3>(block, weights, high, low);
+
+        //  four colours need colour0 > colour1, three colours and transparency colour0 <= colour1
+        uint16_t colour0 = pack565(high), colour1 = pack565(low);
+        if ((colour0 < colour1) != transparent && colour0 != colour1)
+            std::swap(colour0, colour1);
+        bool fourcolours = colour0 > colour1;
+
+        Texel palette[4] = {unpack565(colour0), unpack565(colour1)};
+        for (std::size_t c = 0; c < 3; ++c)
+        {
+            if (fourcolours)
+            {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+            else
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2.0f;
+        }
+
+        uint32_t indices = 0;
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            uint32_t best = 3;
+            if (weights[i] != 0.0f)
+            {
+                best = 0;
+                for (uint32_t entry = 1; entry < (fourcolours ? 4u : 3u); ++entry)
+                    if (distance<3>(block[i], palette[entry]) < distance<3>(block[i], palette[best]))
+                        best = entry;
+            }
+            indices |= best << (2 * i);
+        }
+
+        std::memcpy(bytes.data(),     &colour0, 2);
+        std::memcpy(bytes.data() + 2, &colour1, 2);
+        std::memcpy(bytes.data() + 4, &indices, 4);
+        return bytes;
+    }
+
+    //  7 bit endpoint plus the shared low bit which fits it best
+    void quantizeBC7(const Texel& endpoint, std::array<uint32_t, 4>& quantized, uint32_t& pbit)
+    {
+        float besterror = 0.0f;
+        for (uint32_t p = 0; p < 2; ++p)
+        {
+            std::array<uint32_t, 4> candidate{};
+            float error = 0.0f;
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                candidate[c] = static_cast<uint32_t>(std::clamp(std::lround((endpoint[c] - p) / 2.0f), 0l, 127l));
+
+                float value = static_cast<float>(candidate[c] << 1 | p);
+                error += (value - endpoint[c]) * (value - endpoint[c]);
+            }
+
+            if (p == 0 || error < besterror)
+            {
+                besterror = error;
+                quantized = candidate;
+                pbit      = p;
+            }
+        }
+    }
+
+    //  mode 6: one subset, RGBA endpoints of 7 bits and a p-bit each, 4 bit indices
+    std::array<unsigned char, 16> encodeBC7(const Block& block)
+    {
+        static constexpr uint32_t WEIGHTS[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+        std::array<float, 16> weights{};
+        weights.fill(1.0f);
+
+        Texel high, low;
+        fitEndpoints<4>(block, weights, high, low);
+
+        std::array<uint32_t, 4> endpoints[2];
+        uint32_t                pbits[2];
+        quantizeBC7(low,  endpoints[0], pbits[0]);
+        quantizeBC7(high, endpoints[1], pbits[1]);
+
+        Texel palette[16];
+        for (uint32_t entry = 0; entry < 16; ++entry)
+            for (std::size_t c = 0; c < 4; ++c)
+            {
+                uint32_t e0 = endpoints[0][c] << 1 | pbits[0], e1 = endpoints[1][c] << 1 | pbits[1];
+                palette[entry][c] = static_cast<float>(((64 - WEIGHTS[entry]) * e0 + WEIGHTS[entry] * e1 + 32) >> 6);
+            }
+
+        uint32_t indices[16];
+        for (uint32_t i = 0; i < 16; ++i)
+        {
+            indices[i] = 0;
+            for (uint32_t entry = 1; entry < 16; ++entry)
+                if (distance<4>(block[i], palette[entry]) < distance<4>(block[i], palette[indices[i]]))
+                    indices[i] = entry;
+        }
+
+        //  the top bit of the first index is implied zero, swapping the endpoints mirrors the indices
+        if (indices[0] & 8)
+        {
+            std::swap(endpoints[0], endpoints[1]);
+            std::swap(pbits[0],         pbits[1]);
+            for (auto& index : indices)
+                index = 15 - index;
+        }
+
+        std::array<unsigned char, 16> bytes{};
+        BitWriter writer{bytes};
+        writer.put(1u << 6, 7);
+        for (std::size_t c = 0; c < 4; ++c)
+        {
+            writer.put(endpoints[0][c], 7);
+            writer.put(endpoints[1][c], 7);
+        }
+        writer.put(pbits[0], 1);
+        writer.put(pbits[1], 1);
+        for (uint32_t i = 0; i < 16; ++i)
+            writer.put(indices[i], i == 0 ? 3 : 4);
+
+        return bytes;
+    }
+
+    //  blocks of one RGBA8 level, texels past the edges repeat the last row and column
+    void encodeLevel(VkFormat format, const unsigned char* pixels, uint32_t width, uint32_t height, std::vector<unsigned char>& out)
+    {
+        for (uint32_t by = 0; by < (height + 3) / 4; ++by)
+            for (uint32_t bx = 0; bx < (width + 3) / 4; ++bx)
+            {
+                Block block;
+                for (uint32_t i = 0; i < 16; ++i)
+                {
+                    uint32_t x = std::min(bx * 4 + i % 4, width - 1), y = std::min(by * 4 + i / 4, height - 1);
+                    for (std::size_t c = 0; c < 4; ++c)
+                        block[i][c] = pixels[(static_cast<std::size_t>(y) * width + x) * 4 + c];
+                }
+
+                auto bytes = format == VK_FORMAT_BC7_SRGB_BLOCK ? encodeBC7(block) : encodeBC1(block);
+                out.insert(out.end(), bytes.begin(), bytes.begin() + VKKtx::blockSize(format));
+            }
+    }
+
+    VKKtx::Texture convert(const std::string& filepath, VkFormat format)
+    {
+        int width, height, channels;
+        stbi_uc* pixels = stbi_load(filepath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+        if (!pixels)
+            throw std::runtime_error("failed to load texture image " + filepath + "!");
+
+        VKKtx::Texture texture{};
+        texture.format = format;
+        texture.width  = static_cast<uint32_t>(width);
+        texture.height = static_cast<uint32_t>(height);
+
+        std::vector<unsigned char> level (pixels, pixels + static_cast<std::size_t>(width) * height * 4);
+        std::vector<unsigned char> next;
+        stbi_image_free(pixels);
+
+        //  the full chain down to 1x1, as the runtime builds it for uncompressed textures
+        while (true)
+        {
+            VKKtx::Level info{};
+            info.offset = texture.data.size();
+            info.width  = static_cast<uint32_t>(width);
+            info.height = static_cast<uint32_t>(height);
+
+            encodeLevel(format, level.data(), info.width, info.height, texture.data);
+            info.size = texture.data.size() - info.offset;
+            texture.levels.push_back(info);
+
+            if (width == 1 && height == 1)
+                break;
+
+            VKKtx::downsampleSRGB(level.data(), width, height, next);
+            level.swap(next);
+
+            width  = std::max(width  / 2, 1);
+            height = std::max(height / 2, 1);
+        }
+
+        return texture;
+    }
+}
+
+//  usage: ktxconvert [--format bc7|bc1] image...
+//  every image is written next to itself as name.<format>.ktx2 with all mip levels
+int main(int argc, char* argv[])
+{
+    const std::map<std::string, VkFormat> formats {{"bc7", VK_FORMAT_BC7_SRGB_BLOCK},
+                                                   {"bc1", VK_FORMAT_BC1_RGBA_SRGB_BLOCK}};
+
+    VkFormat                 format = VK_FORMAT_BC7_SRGB_BLOCK;
+    std::vector<std::string> images;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+
+        if (argument == "--format" && i + 1 < argc && formats.count(argv[i + 1]))
+            format = formats.at(argv[++i]);
+        else if (!argument.starts_with("--"))
+            images.push_back(argument);
+        else
+        {
+            std::cerr << "unknown argument: " << argument << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (images.empty())
+    {
+        std::cerr << "usage: ktxconvert [--format bc7|bc1] image..." << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        for (auto& image : images)
+        {
+            auto texture = convert(image, format);
+            auto output  = VKKtx::compressedPath(image, format);
+
+            VKKtx::write(output, texture);
+            std::cout << output << ": " << texture.width << "x" << texture.height << ", " << texture.levels.size()
+                      << " levels, " << texture.getSize() << " bytes" << std::endl;
+        }
+    }
+    catch(const std::exception& exception)
+    {
+        std::cerr << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
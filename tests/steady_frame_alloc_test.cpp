@@ -0,0 +1,96 @@
+#include "alloc_counter.hpp"
+#include "thread_pool.hpp"
+#include "frame_arena.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace
+{
+    //  frames run before counting starts; the arena merges its blocks and the scratch vectors reach their capacity there
+    constexpr int WARMUP_FRAMES = 4;
+    constexpr int STEADY_FRAMES = 64;
+
+    constexpr std::size_t OBJECTS   = 20000;
+    constexpr std::size_t RECORDERS =     8;
+
+    struct DrawEntry
+    {
+        const void*        model;
+        uint32_t   firstinstance;
+        uint32_t   instancecount;
+    };
+
+    //  the CPU side of a frame: a draw list and a lookup in the arena, kept scratch vectors refilled, then ranges of the
+    //  list worked off by the pool like secondary command buffers are recorded, one of them nesting a parallel_for
+    class FrameWorkload
+    {
+        VKThreadPool::ThreadPool              pool_ {3};
+        VKFrameArena::FrameArena             arena_ {1024};   //  far too small at first, so the warmup has to grow it
+        std::vector<uint32_t>               visible_;
+        std::vector<uint64_t>                  sums_ = std::vector<uint64_t>(RECORDERS);
+
+    public:
+
+        void frame(uint32_t frameindex)
+        {
+            arena_.reset();
+
+            auto draws  = arena_.allocate<DrawEntry>(OBJECTS);
+            auto lookup = arena_.allocate<uint32_t> (OBJECTS * 2);
+
+            visible_.clear();
+            for (uint32_t object = 0; object < OBJECTS; ++object)
+            {
+                draws [object]     = DrawEntry{&draws[object], object, (object + frameindex) % 7};
+                lookup[object * 2] =                                                      object;
+                if ((object + frameindex) % 3 != 0)
+                    visible_.push_back(object);
+            }
+
+            pool_.parallel_for(RECORDERS, [&](std::size_t recorder)
+            {
+                std::size_t first =  recorder      * visible_.size() / RECORDERS;
+                std::size_t  last = (recorder + 1) * visible_.size() / RECORDERS;
+
+                uint64_t sum = 0;
+                for (std::size_t index = first; index < last; ++index)
+                    sum += draws[visible_[index]].instancecount;
+
+                if (recorder == 0)
+                    pool_.parallel_for(4, [&](std::size_t i) { sum += lookup[i * 2]; });
+
+                sums_[recorder] = sum;
+            });
+        }
+    };
+}
+
+//  without the counting operator new every check below would pass trivially
+TEST(SteadyFrameAllocations, CounterSeesOperatorNew)
+{
+    auto before = VKAllocCounter::allocations();
+    auto value  =   std::make_unique<int>(42);
+
+    EXPECT_EQ(VKAllocCounter::allocations(), before + 1);
+    EXPECT_EQ(*value, 42);
+}
+
+TEST(SteadyFrameAllocations, SteadyFramesAllocateNothing)
+{
+    FrameWorkload workload;
+
+    uint32_t frameindex = 0;
+    for (; frameindex < WARMUP_FRAMES; ++frameindex)
+        workload.frame(frameindex);
+
+    //  all threads are counted, the workers of the pool included
+    auto before = VKAllocCounter::allocations();
+    for (; frameindex < WARMUP_FRAMES + STEADY_FRAMES; ++frameindex)
+        workload.frame(frameindex);
+
+    EXPECT_EQ(VKAllocCounter::allocations() - before, 0u);
+}
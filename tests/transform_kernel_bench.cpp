@@ -0,0 +1,83 @@
+#include "transform_system.hpp"
+#include "object.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+
+//  usage: transform_kernel_bench [objects] [repeats]
+//  ns per object of composeMatrices against Transform3Dcomponent::mat4() plus normalMatrix(), best of the repeats
+int main(int argc, char* argv[])
+{
+    std::size_t count   = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    int         repeats = argc > 2 ?   std::atoi(argv[2])               :     20;
+    if (count == 0 || repeats <= 0)
+    {
+        std::cerr << "usage: transform_kernel_bench [objects] [repeats]" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937                          engine {1};
+    std::uniform_real_distribution<float> angle  {-glm::pi<float>(), glm::pi<float>()};
+    std::uniform_real_distribution<float> value  {0.5f, 2.0f};
+
+    VKTransformSystem::Components             translations, rotations, scales;
+    std::vector<VKObject::Transform3Dcomponent> transforms (count);
+    for (auto& transform : transforms)
+    {
+        transform.translation = {value(engine), value(engine), value(engine)};
+        transform.rotation    = {angle(engine), angle(engine), angle(engine)};
+        transform.scale       = {value(engine), value(engine), value(engine)};
+
+        translations.push_back(transform.translation);
+        rotations   .push_back(transform.rotation);
+        scales      .push_back(transform.scale);
+    }
+
+    std::vector<glm::mat4> worlds    (count);
+    std::vector<glm::mat4> normals   (count);
+    std::vector<float>     maxscales (count);
+
+    //  best run in ns per object; the outputs are read afterwards so no pass can be dropped
+    auto measure = [&](auto&& body)
+    {
+        double best = 0.0;
+        for (int repeat = 0; repeat < repeats; ++repeat)
+        {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto   end = std::chrono::steady_clock::now();
+
+            double ns = std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(count);
+            best      = repeat == 0 ? ns : std::min(best, ns);
+        }
+        return best;
+    };
+
+    double kernel = measure([&]
+    {
+        VKTransformSystem::composeMatrices(translations, rotations, scales, worlds.data(), normals.data(), maxscales.data());
+    });
+
+    double scalar = measure([&]
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            worlds [i] =                    transforms[i].mat4();
+            normals[i] = glm::mat4{transforms[i].normalMatrix()};
+        }
+    });
+
+    float checksum = 0.0f;
+    for (std::size_t i = 0; i < count; ++i)
+        checksum += worlds[i][3][0] + normals[i][0][0];
+
+    std::cout << count << " objects, best of " << repeats << " runs" << std::endl;
+    std::cout << "composeMatrices:        " << kernel << " ns/object" << std::endl;
+    std::cout << "mat4 and normalMatrix:  " << scalar << " ns/object" << std::endl;
+    std::cout << "speedup:                " << scalar / kernel << "x (checksum " << checksum << ")" << std::endl;
+
+    return EXIT_SUCCESS;
+}
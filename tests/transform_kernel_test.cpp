@@ -0,0 +1,115 @@
+#include "transform_system.hpp"
+#include "object.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace
+{
+    //  kernel and scalar formulas evaluate sin and cos differently, results may differ by a few ulp of the larger terms
+    constexpr float TOLERANCE = 2e-5f;
+
+    struct Scene
+    {
+        VKTransformSystem::Components translations;
+        VKTransformSystem::Components    rotations;
+        VKTransformSystem::Components       scales;
+    };
+
+    Scene randomScene(std::size_t count, float maxangle, uint32_t seed)
+    {
+        std::mt19937                          engine {seed};
+        std::uniform_real_distribution<float> angle  {-maxangle, maxangle};
+        std::uniform_real_distribution<float> offset {-100.0f, 100.0f};
+        std::uniform_real_distribution<float> factor {0.1f, 4.0f};
+        std::bernoulli_distribution           mirror {0.25};
+
+        auto scale = [&] { return mirror(engine) ? -factor(engine) : factor(engine); };
+
+        Scene scene{};
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            scene.translations.push_back({offset(engine), offset(engine), offset(engine)});
+            scene.rotations   .push_back({ angle(engine),  angle(engine),  angle(engine)});
+            scene.scales      .push_back({        scale(),         scale(),         scale()});
+        }
+
+        return scene;
+    }
+
+    void expectNear(const glm::mat4& actual, const glm::mat4& expected, std::size_t index)
+    {
+        for (int column = 0; column < 4; ++column)
+            for (int row = 0; row < 4; ++row)
+            {
+                float reference = expected[column][row];
+                EXPECT_NEAR(actual[column][row], reference, TOLERANCE * std::max(1.0f, std::fabs(reference)))
+                    << "transform " << index << ", column " << column << ", row " << row;
+            }
+    }
+
+    //  composes the scene with the kernel and checks every transform against Transform3Dcomponent
+    void checkScene(const Scene& scene)
+    {
+        std::size_t count = scene.translations.size();
+
+        std::vector<glm::mat4> worlds    (count);
+        std::vector<glm::mat4> normals   (count);
+        std::vector<float>     maxscales (count);
+
+        VKTransformSystem::composeMatrices(scene.translations, scene.rotations, scene.scales, worlds.data(), normals.data(), maxscales.data());
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            VKObject::Transform3Dcomponent transform {scene.translations.get(i), scene.scales.get(i), scene.rotations.get(i)};
+
+            expectNear(worlds [i],                   transform.mat4(), i);
+            expectNear(normals[i], glm::mat4{transform.normalMatrix()}, i);
+
+            glm::vec3 scale = glm::abs(scene.scales.get(i));
+            EXPECT_FLOAT_EQ(maxscales[i], std::max({scale.x, scale.y, scale.z})) << "transform " << i;
+        }
+    }
+}
+
+//  every count up to a few full AVX2 widths, so the 4 wide lanes and the scalar tail run in every build
+//  and the 8 wide lanes in the AVX2 build of this test
+TEST(TransformKernel, MatchesScalarForEveryTail)
+{
+    for (std::size_t count = 1; count <= 35; ++count)
+    {
+        SCOPED_TRACE("count " + std::to_string(count));
+        checkScene(randomScene(count, glm::pi<float>(), static_cast<uint32_t>(count)));
+    }
+}
+
+TEST(TransformKernel, MatchesScalarForNegativeAngles)
+{
+    auto scene = randomScene(1003, glm::pi<float>(), 7);
+    for (std::size_t i = 0; i < scene.rotations.size(); ++i)
+        scene.rotations.set(i, -glm::abs(scene.rotations.get(i)));
+
+    checkScene(scene);
+}
+
+TEST(TransformKernel, MatchesScalarForLargeAngles)
+{
+    checkScene(randomScene(1003, 1000.0f, 11));
+}
+
+TEST(TransformKernel, ComposesIdentity)
+{
+    Scene scene{};
+    for (int i = 0; i < 13; ++i)
+    {
+        scene.translations.push_back(glm::vec3{0.0f});
+        scene.rotations   .push_back(glm::vec3{0.0f});
+        scene.scales      .push_back(glm::vec3{1.0f});
+    }
+
+    checkScene(scene);
+}